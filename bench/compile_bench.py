@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""Compile-time benchmark for static_bignum.hpp.
+
+Generates one translation unit per operation and operand size, compiles each
+with every given compiler and records wall time, peak resident memory and
+template instantiation statistics into a JSON and a CSV report.
+"""
+
+import argparse
+import csv
+import json
+import os
+import random
+import re
+import subprocess
+import sys
+import time
+
+OPERATIONS = ['prod', 'div', 'dec', 'gcd']
+
+FIELDS = ['compiler', 'operation', 'limbs', 'status', 'wall_seconds',
+          'peak_rss_kib', 'instantiations', 'instantiation_seconds']
+
+
+def number(value):
+    """Type of the unsigned number `value`, built from 64-bit digits so that it
+    does not depend on STATIC_BIGNUM_LIMB_BITS."""
+    words = []
+    while value:
+        words.append('%dULL' % (value & 0xFFFFFFFFFFFFFFFF))
+        value >>= 64
+    return 'static_bignum::PackWords64<%s>::Result' % ', '.join(words)
+
+
+def operand(rng, limbs):
+    return rng.getrandbits(64 * limbs) | (1 << (64 * limbs - 1))
+
+
+def source(operation, limbs, seed):
+    rng = random.Random('%s-%d-%d' % (operation, limbs, seed))
+    lines = ['#include "static_bignum.hpp"', '']
+    if operation == 'prod':
+        lines += ['using A = %s;' % number(operand(rng, limbs)),
+                  'using B = %s;' % number(operand(rng, limbs)),
+                  'using X = static_bignum::Product<A, B>::Result;']
+    elif operation == 'div':
+        lines += ['using A = %s;' % number(operand(rng, 2 * limbs)),
+                  'using B = %s;' % number(operand(rng, limbs)),
+                  'using X = static_bignum::Division<A, B>::Quotient;']
+    elif operation == 'dec':
+        lines += ['using X = %s;' % number(operand(rng, limbs)),
+                  'const char* keep = X::dec_c_str();']
+    elif operation == 'gcd':
+        lines += ['using A = %s;' % number(operand(rng, limbs)),
+                  'using B = %s;' % number(operand(rng, limbs)),
+                  'using X = static_bignum::EuclideanAlgorithm<A, B>::GCD::Abs;']
+    lines += ['static_assert(X::length >= 0, "");', '']
+    return '\n'.join(lines)
+
+
+def compiler_kind(compiler):
+    try:
+        version = subprocess.run([compiler, '--version'], stdout=subprocess.PIPE,
+                                 stderr=subprocess.STDOUT, universal_newlines=True).stdout
+    except OSError:
+        return None
+    return 'clang' if 'clang' in version else 'gcc'
+
+
+def run(command, timeout, log_path):
+    """Run `command`, returning (exit status, stderr, wall time, peak RSS in KiB)."""
+    start = time.monotonic()
+    with open(log_path, 'w') as log:
+        process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=log)
+        # wait4 reports the resource usage of this child alone
+        while True:
+            pid, status, usage = os.wait4(process.pid, os.WNOHANG)
+            if pid:
+                break
+            if time.monotonic() - start > timeout:
+                process.kill()
+                os.wait4(process.pid, 0)
+                return None, '', timeout, None
+            time.sleep(0.005)
+    wall = time.monotonic() - start
+    with open(log_path) as log:
+        stderr = log.read()
+    rss = usage.ru_maxrss
+    if sys.platform == 'darwin':
+        rss //= 1024
+    return os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1, stderr, wall, rss
+
+
+def gcc_instantiation_seconds(report):
+    for line in report.splitlines():
+        if line.strip().startswith('template instantiation'):
+            values = re.findall(r'(\d+\.\d+)\s*\(', line)
+            if len(values) >= 3:
+                return float(values[2])
+    return None
+
+
+def clang_instantiations(trace_path):
+    """Count of instantiations and their total duration from a -ftime-trace file."""
+    try:
+        with open(trace_path) as trace:
+            events = json.load(trace)['traceEvents']
+    except (OSError, ValueError, KeyError):
+        return None, None
+    count = 0
+    seconds = 0.0
+    for event in events:
+        name = event.get('name')
+        if name in ('InstantiateClass', 'InstantiateFunction'):
+            count += 1
+        elif name in ('Total InstantiateClass', 'Total InstantiateFunction'):
+            seconds += event.get('dur', 0) / 1e6
+    return count, seconds
+
+
+def measure(compiler, kind, operation, limbs, args):
+    name = '%s_%d' % (operation, limbs)
+    path = os.path.join(args.work_dir, name + '.cpp')
+    with open(path, 'w') as tu:
+        tu.write(source(operation, limbs, args.seed))
+    obj = os.path.join(args.work_dir, '%s.%s.o' % (name, kind))
+    command = [compiler, '-std=' + args.std, '-c', path, '-o', obj,
+               '-I', args.include_dir, '-ftemplate-depth=%d' % args.template_depth]
+    if kind == 'clang':
+        command += ['-ftime-trace', '-ftime-trace-granularity=0']
+    else:
+        command += ['-ftime-report']
+    command += args.flags
+    status, stderr, wall, rss = run(command, args.timeout,
+                                    os.path.join(args.work_dir, '%s.%s.log' % (name, kind)))
+
+    row = dict.fromkeys(FIELDS, '')
+    row.update(compiler=compiler, operation=operation, limbs=limbs,
+               wall_seconds=round(wall, 3))
+    if status is None:
+        row['status'] = 'timeout'
+        return row
+    row['status'] = 'ok' if status == 0 else 'error'
+    row['peak_rss_kib'] = rss
+    if kind == 'clang':
+        count, seconds = clang_instantiations(os.path.splitext(obj)[0] + '.json')
+        row['instantiations'] = '' if count is None else count
+        row['instantiation_seconds'] = '' if seconds is None else round(seconds, 3)
+    else:
+        seconds = gcc_instantiation_seconds(stderr)
+        row['instantiation_seconds'] = '' if seconds is None else seconds
+    if status != 0 and args.verbose:
+        sys.stderr.write(stderr)
+    return row
+
+
+def regressions(rows, baseline_path, tolerance):
+    with open(baseline_path) as baseline:
+        old = {(r['compiler'], r['operation'], r['limbs']): r for r in json.load(baseline)}
+    found = []
+    for row in rows:
+        previous = old.get((row['compiler'], row['operation'], row['limbs']))
+        if previous is None or previous['status'] != 'ok':
+            continue
+        if row['status'] != 'ok':
+            found.append('%s %s/%d: %s' % (row['compiler'], row['operation'], row['limbs'], row['status']))
+            continue
+        for field in ('wall_seconds', 'peak_rss_kib'):
+            if previous[field] and row[field] > previous[field] * (1 + tolerance):
+                found.append('%s %s/%d: %s %s -> %s' % (row['compiler'], row['operation'],
+                                                         row['limbs'], field, previous[field], row[field]))
+    return found
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--compiler', action='append', required=True,
+                        help='compiler to benchmark, may be repeated')
+    parser.add_argument('--operations', default=','.join(OPERATIONS))
+    parser.add_argument('--sizes', default='1,2,4,8,16,32,64',
+                        help='comma separated operand sizes in 64-bit words')
+    parser.add_argument('--std', default='c++11')
+    parser.add_argument('--flags', default='', help='extra compiler flags')
+    parser.add_argument('--template-depth', type=int, default=4096)
+    parser.add_argument('--timeout', type=float, default=300,
+                        help='seconds before a compilation is abandoned')
+    parser.add_argument('--seed', type=int, default=0)
+    parser.add_argument('--include-dir', default=os.path.join(os.path.dirname(__file__), '..'))
+    parser.add_argument('--work-dir', default='compile_bench')
+    parser.add_argument('--json', default='compile_bench.json')
+    parser.add_argument('--csv', default='compile_bench.csv')
+    parser.add_argument('--baseline', help='JSON report to compare against')
+    parser.add_argument('--tolerance', type=float, default=0.25,
+                        help='allowed relative growth over the baseline')
+    parser.add_argument('--verbose', action='store_true')
+    args = parser.parse_args()
+    args.flags = args.flags.split()
+    args.include_dir = os.path.abspath(args.include_dir)
+    os.makedirs(args.work_dir, exist_ok=True)
+
+    operations = [op for op in args.operations.split(',') if op]
+    for op in operations:
+        if op not in OPERATIONS:
+            parser.error('unknown operation %s' % op)
+    sizes = [int(size) for size in args.sizes.split(',') if size]
+
+    rows = []
+    for compiler in args.compiler:
+        kind = compiler_kind(compiler)
+        if kind is None:
+            sys.stderr.write('skipping %s: not found\n' % compiler)
+            continue
+        for operation in operations:
+            skip = False
+            for limbs in sizes:
+                if skip:
+                    # larger operands are not going to compile faster
+                    rows.append(dict(dict.fromkeys(FIELDS, ''), compiler=compiler,
+                                     operation=operation, limbs=limbs, status='skipped'))
+                    continue
+                row = measure(compiler, kind, operation, limbs, args)
+                rows.append(row)
+                print('%-10s %-5s %3d limbs: %-7s %8.3fs %8s KiB' % (
+                    os.path.basename(compiler), operation, limbs, row['status'],
+                    row['wall_seconds'], row['peak_rss_kib']))
+                sys.stdout.flush()
+                skip = row['status'] == 'timeout'
+
+    with open(args.json, 'w') as output:
+        json.dump(rows, output, indent=1)
+    with open(args.csv, 'w', newline='') as output:
+        writer = csv.DictWriter(output, fieldnames=FIELDS)
+        writer.writeheader()
+        writer.writerows(rows)
+
+    if args.baseline:
+        found = regressions(rows, args.baseline, args.tolerance)
+        for line in found:
+            print('regression: ' + line)
+        return 1 if found else 0
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
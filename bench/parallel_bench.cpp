@@ -0,0 +1,76 @@
+// Scaling of BatchExecutor with the number of threads: reduction and
+// modular exponentiation of elements numbers modulo a static 4-word
+// modulus, for 1, 2, 4, ... threads up to the hardware thread count. Each
+// run reports its throughput, the speedup over one thread and the slowest
+// and fastest worker.
+//
+//     parallel_bench [--csv] [elements]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "static_bignum_parallel.hpp"
+
+using namespace static_bignum;
+
+static bool csv = false;
+
+// pseudorandom odd 4 x 64-bit modulus with the top bit set
+using Modulus = PackWords64<0x9E3779B97F4A7C15ULL, 0xBF58476D1CE4E5B9ULL,
+    0x94D049BB133111EBULL, 0xD6E8FEB86659FD93ULL>::Result;
+static const size_t limbs = 2 * Montgomery<Modulus>::length;
+
+template<class F>
+void scale(const char* name, size_t elements, F f) {
+    const size_t hardware = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+    double single = 0;
+    for (size_t threads = 1;; threads = threads * 2 < hardware ? threads * 2 : hardware) {
+        BatchExecutor executor(threads);
+        f(executor);  // warms up the scratch arenas
+        const ParallelStats stats = f(executor);
+        if (threads == 1)
+            single = stats.throughput();
+        double slowest = stats.workers[0].throughput(), fastest = slowest;
+        size_t stolen = 0;
+        for (size_t w = 0; w < stats.workers.size(); ++w) {
+            const double throughput = stats.workers[w].throughput();
+            slowest = throughput < slowest ? throughput : slowest;
+            fastest = throughput > fastest ? throughput : fastest;
+            stolen += stats.workers[w].stolen;
+        }
+        std::printf(csv ? "%s,%zu,%zu,%.4f,%.3f,%.2f,%.3f,%.3f,%zu\n"
+                        : "%-10s %9zu %7zu %9.4f %10.3f %7.2f %10.3f %10.3f %6zu\n",
+            name, elements, threads, stats.seconds, stats.throughput() / 1e6,
+            single > 0 ? stats.throughput() / single : 0, slowest / 1e6, fastest / 1e6, stolen);
+        if (threads == hardware)
+            return;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t elements = size_t(1) << 20;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0)
+            csv = true;
+        else
+            elements = std::strtoul(argv[i], nullptr, 10);
+    }
+    std::printf(csv ? "%s,%s,%s,%s,%s,%s,%s,%s,%s\n" : "%-10s %9s %7s %9s %10s %7s %10s %10s %6s\n",
+        "benchmark", "elements", "threads", "seconds", "Melem/s", "speedup", "min Melem/s", "max Melem/s", "stolen");
+
+    std::vector<word> a(limbs * elements), r(limbs * elements);
+    for (size_t i = 0; i < a.size(); ++i)
+        a[i] = static_cast<word>((i + 1) * 0x9E3779B97F4A7C15ULL ^ i >> 3);
+    const word e[] = {static_cast<word>(65537)};
+
+    scale("reduce", elements, [&](BatchExecutor& executor) {
+        return executor.reduce<limbs>(r.data(), a.data(), Modulus(), elements);
+    });
+    scale("pow_65537", elements, [&](BatchExecutor& executor) {
+        return executor.pow_mod<limbs>(r.data(), a.data(), e, 1, Modulus(), elements);
+    });
+    return 0;
+}
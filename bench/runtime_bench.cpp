@@ -0,0 +1,283 @@
+// Runtime cost of the accessors generated for static numbers and of the
+// kernels built on them: ns per call, heap allocations and bytes allocated
+// per call. Allocations are counted by replacing the global operator new.
+// Operand sizes are given in 64-bit digits whatever STATIC_BIGNUM_LIMB_BITS,
+// except for decimal conversion of runtime numbers, which is sized in words.
+//
+//     runtime_bench [--csv] [filter]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include "static_bignum.hpp"
+
+using namespace static_bignum;
+
+///////////////////////////////////////////////////////////////////////////
+//////////////////////////// allocation counter ///////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+static size_t allocations = 0;
+static size_t allocated_bytes = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    allocated_bytes += size;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+///////////////////////////////////////////////////////////////////////////
+///////////////////////////////// harness /////////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// keeps the compiler from dropping a computation whose result is unused
+template<class T>
+inline void keep(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+static bool csv = false;
+static const char* filter = nullptr;
+
+template<class F>
+void run(const char* name, size_t limbs, F f) {
+    if (filter && !std::strstr(name, filter))
+        return;
+    using Clock = std::chrono::steady_clock;
+    // double the iteration count until a run takes at least 50 ms
+    for (size_t iterations = 1;; iterations *= 2) {
+        const size_t allocations_before = allocations, bytes_before = allocated_bytes;
+        const Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            f();
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (ns < 5e7)
+            continue;
+        const double calls = static_cast<double>(iterations);
+        std::printf(csv ? "%s,%zu,%.2f,%.2f,%.1f\n" : "%-16s %3zu %12.2f %10.2f %12.1f\n",
+            name, limbs, ns / calls,
+            (allocations - allocations_before) / calls,
+            (allocated_bytes - bytes_before) / calls);
+        return;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+///////////////////////////////// operands ////////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+constexpr uint64_t mix(uint64_t x) {
+    return (x ^ (x >> 31)) * 0x94D049BB133111EBULL;
+}
+
+// pseudorandom 64-bit digit i of an n-digit operand: odd, with the top bit set
+constexpr uint64_t operand_digit(size_t i, size_t n) {
+    return mix(mix((i + 1) * 0x9E3779B97F4A7C15ULL + n))
+        | (i == 0 ? 1 : 0) | (i + 1 == n ? 1ULL << 63 : 0);
+}
+
+template<size_t n, class I = typename MakeIndexSequence<n>::Result> struct Operand;
+
+template<size_t n, size_t... i>
+struct Operand<n, IndexSequence<i...>> {
+    using Result = typename PackWords64<operand_digit(i, n)...>::Result;
+};
+
+///////////////////////////////////////////////////////////////////////////
+//////////////////////////////// benchmarks ///////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+static volatile size_t digit_index = 0;
+
+template<size_t n>
+void accessors() {
+    using X = typename Operand<n>::Result;
+    run("dec", n, [] { keep(X::dec()); });
+    run("hex", n, [] { keep(X::hex()); });
+    run("bin", n, [] { keep(X::bin()); });
+    run("dec_c_str", n, [] { keep(std::strlen(X::dec_c_str())); });
+    run("write_to", n, [] {
+        word words[X::length];
+        X::write_to(words);
+        keep(words);
+    });
+    run("to_bytes_be", n, [] {
+        uint8_t bytes[sizeof(word) * X::length];
+        X::to_bytes_be(bytes);
+        keep(bytes);
+    });
+    run("get_digit", n, [] { keep(X::get_digit(digit_index % X::length)); });
+}
+
+template<size_t n>
+void kernels() {
+    using M = typename Operand<n>::Result;
+    static const size_t length = M::length;
+    static word a[2 * length], b[2 * length], r[2 * length], q[2 * length];
+    for (size_t i = 0; i < 2 * length; ++i) {
+        a[i] = static_cast<word>(mix(i + 1));
+        b[i] = static_cast<word>(mix(i + 2 * length + 1));
+    }
+    // reduced Montgomery operands
+    a[length - 1] >>= 1;
+    b[length - 1] >>= 1;
+    run("montgomery_mul", n, [] {
+        Montgomery<M>::mul(r, a, b);
+        keep(r);
+    });
+    a[2 * length - 1] >>= 1;
+    run("barrett_reduce", n, [] {
+        BarrettReducer<M>::reduce(r, a);
+        keep(r);
+    });
+    run("invariant_div", n, [] {
+        InvariantDivisor<M>::divide(q, r, a, 2 * length);
+        keep(q);
+        keep(r);
+    });
+    static Fixed<length> x, y;
+    for (size_t i = 0; i < length; ++i) {
+        x.words[i] = a[i];
+        y.words[i] = b[i];
+    }
+    run("fixed_add", n, [] { keep(x + y); });
+    run("fixed_mul", n, [] { keep(multiply(x, y)); });
+    run("fixed_mul_static", n, [] { keep(x * M()); });
+    run("fixed_div_static", n, [] { keep(x / M()); });
+}
+
+// decimal conversion of runtime numbers of n words, divide and conquer
+// against one chunk at a time
+template<size_t n>
+void decimals() {
+    static word a[n], r[n], t[decimal_scratch_length(n)];
+    static char s[decimal_length_bound(n)];
+    for (size_t i = 0; i < n; ++i)
+        a[i] = static_cast<word>(mix(i + 1));
+    static const size_t length = to_decimal(s, a, n, t);
+    run("to_decimal", n, [] { keep(to_decimal(s, a, n, t)); });
+    run("from_decimal", n, [] { keep(from_decimal(r, n, s, length, t)); });
+    run("decimal_chunks", n, [] {
+        std::memcpy(r, a, sizeof(a));
+        char* out = s;
+        word chunks[decimal_digits_bound(n) / chunk_digits + 1];
+        size_t count = 0;
+        for (size_t m = n; m > 0; m = significant_words(r, m))
+            WordInvariantDivisor<power_of_10(chunk_digits)>::divide(r, chunks + count++, r, m);
+        for (size_t i = count; i-- > 0;)
+            out = write_chunk(out, chunks[i], i + 1 < count);
+        keep(s);
+    });
+}
+
+// batch kernels over batch_elements numbers per call, for every instruction
+// set the CPU has
+static const size_t batch_elements = 1024;
+static const char* const batch_targets[] = {"portable", "avx2", "avx512"};
+
+template<size_t n>
+void batches() {
+    using M = typename Operand<n>::Result;
+    static const size_t length = M::length;
+    static word a[length * batch_elements], b[length * batch_elements], r[length * batch_elements];
+    static int8_t s[batch_elements];
+    for (size_t i = 0; i < length * batch_elements; ++i) {
+        a[i] = static_cast<word>(mix(i + 1));
+        b[i] = static_cast<word>(mix(i + length * batch_elements + 1));
+    }
+    // reduced Montgomery operands
+    for (size_t k = 0; k < batch_elements; ++k) {
+        a[(length - 1) * batch_elements + k] >>= 1;
+        b[(length - 1) * batch_elements + k] >>= 1;
+    }
+    const BatchTarget best = batch_target();
+    for (int target = 0; target <= static_cast<int>(best); ++target) {
+        batch_target() = static_cast<BatchTarget>(target);
+        const std::string suffix = std::string("/") + batch_targets[target];
+        run(("batch_add" + suffix).c_str(), n, [] {
+            Batch<length>::add(r, a, b, batch_elements);
+            keep(r);
+        });
+        run(("batch_compare" + suffix).c_str(), n, [] {
+            Batch<length>::compare(s, a, b, batch_elements);
+            keep(s);
+        });
+        run(("batch_reduce" + suffix).c_str(), n, [] {
+            Batch<length>::reduce(r, a, typename Operand<(n + 1) / 2>::Result(), batch_elements);
+            keep(r);
+        });
+        run(("batch_montgomery" + suffix).c_str(), n, [] {
+            Batch<length>::montgomery_mul(r, a, b, M(), batch_elements);
+            keep(r);
+        });
+    }
+    batch_target() = best;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0)
+            csv = true;
+        else
+            filter = argv[i];
+    }
+    std::printf(csv ? "%s,%s,%s,%s,%s\n" : "%-16s %3s %12s %10s %12s\n",
+        "benchmark", "limbs", "ns/op", "allocs/op", "bytes/op");
+
+    accessors<1>();
+    accessors<2>();
+    accessors<4>();
+    accessors<8>();
+    accessors<16>();
+    accessors<32>();
+    accessors<64>();
+
+    kernels<1>();
+    kernels<2>();
+    kernels<4>();
+    kernels<8>();
+    kernels<16>();
+    kernels<32>();
+    kernels<64>();
+
+    decimals<16>();
+    decimals<64>();
+    decimals<256>();
+    decimals<1024>();
+
+    batches<2>();
+    batches<4>();
+    batches<8>();
+    return 0;
+}
@@ -1,29 +1,116 @@
 #ifndef STATIC_BIGNUM_HPP
 #define STATIC_BIGNUM_HPP
 
-#include <bitset>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <type_traits>
+#include <utility>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#if defined(STATIC_BIGNUM_CONSTEXPR_BACKEND) && __cplusplus < 201402L
+#error "STATIC_BIGNUM_CONSTEXPR_BACKEND requires C++14 or later"
+#endif
+
+#ifndef STATIC_BIGNUM_LIMB_BITS
+#define STATIC_BIGNUM_LIMB_BITS 64
+#endif
+
+// carry chains of runtime numbers: compiler builtins where available, x86-64
+// intrinsics otherwise, plain comparisons as the last resort
+#if STATIC_BIGNUM_LIMB_BITS == 64 && defined(__has_builtin)
+#if __has_builtin(__builtin_addcll) && __has_builtin(__builtin_subcll)
+#define STATIC_BIGNUM_BUILTIN_ADDC
+#endif
+#endif
+#if STATIC_BIGNUM_LIMB_BITS == 64 && !defined(STATIC_BIGNUM_BUILTIN_ADDC) \
+    && (defined(__x86_64__) || defined(_M_X64))
+#define STATIC_BIGNUM_ADDCARRY_INTRINSICS
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#endif
 
 namespace static_bignum {
 
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+// digits are words of STATIC_BIGNUM_LIMB_BITS bits: 32, 64 (the default) or
+// 128, the latter where the compiler has unsigned __int128
+#if STATIC_BIGNUM_LIMB_BITS == 32
+using word = uint32_t;
+#elif STATIC_BIGNUM_LIMB_BITS == 64
+using word = uint64_t;
+#elif STATIC_BIGNUM_LIMB_BITS == 128 && defined(__SIZEOF_INT128__)
+using word = uint128_t;
+#else
+#error "STATIC_BIGNUM_LIMB_BITS must be 32, 64 or 128 (the latter with unsigned __int128)"
+#endif
+
+constexpr size_t word_bits = STATIC_BIGNUM_LIMB_BITS;
+constexpr word word_max = ~static_cast<word>(0);
+
 // some forward declarations
 template<class A> struct DecimalRepresentation;
+template<class A> struct HexRepresentation;
+template<class A> struct BinaryRepresentation;
+template<class A, word... digits> struct WordArray;
+template<class A, bool big_endian> struct ByteArray;
+template<class A, class Limb> struct LimbArray;
+template<class A, class F> struct FloatingValue;
+#ifdef STATIC_BIGNUM_CONSTEXPR_BACKEND
+template<class A, class B> struct ConstexprSum;
+template<class A, class B> struct ConstexprDifference;
+template<class A, class B> struct ConstexprProduct;
+template<class A, class B> struct ConstexprDivision;
+template<class A, size_t shift> struct ConstexprShiftLeft;
+template<class A, size_t shift> struct ConstexprShiftRight;
+#endif
 
 struct Zero {
-    static const uint64_t digit = 0;
+    using word = static_bignum::word;
+    static const word digit = 0;
     static const size_t length = 0;
-    using word = uint64_t;
-    static inline std::string bin(void) {
-        return "";
+    static inline std::string bin(void);
+    static inline std::string dec(void);
+    static inline std::string hex(void);
+    static constexpr const char* bin_c_str(void);
+    static constexpr const char* dec_c_str(void);
+    static constexpr const char* hex_c_str(void);
+#if __cplusplus >= 201703L
+    static constexpr std::string_view bin_view(void);
+    static constexpr std::string_view dec_view(void);
+    static constexpr std::string_view hex_view(void);
+#endif
+    static constexpr const word* data(void);
+    static constexpr double to_double(void);
+    static constexpr long double to_long_double(void);
+    static inline void write_to(word* dest) {
+        // no op
+    }
+    template<class Limb>
+    static inline void write_to(Limb* dest) {
+        // no op
+    }
+    template<class Limb>
+    static constexpr size_t length_in(void) {
+        return 0;
+    }
+    static inline void to_bytes_le(uint8_t* dest) {
+        // no op
     }
-    static inline void write_to(uint64_t* dest) {
+    static inline void to_bytes_be(uint8_t* dest) {
         // no op
     }
-    static inline uint64_t get_digit(size_t which) {
-        return 0ULL;
+    static constexpr word get_digit(size_t which) {
+        return 0;
     }
 };
 
@@ -31,25 +118,73 @@ struct ErrorType {
     
 };
 
-template<uint64_t n, class T = Zero>
+template<word n, class T = Zero>
 struct BigUnsigned {
-    static const uint64_t digit = n;
+    using word = static_bignum::word;
+    static const word digit = n;
     static const size_t length = T::length + 1;
     using Next = T;
-    using word = uint64_t;
     static inline std::string bin(void) {
-        std::bitset<64> bset(n);
-        return Next::bin() + bset.to_string();
+        return BinaryRepresentation<BigUnsigned>::str();
     }
     static inline std::string dec(void) {
         return DecimalRepresentation<BigUnsigned>::str();
     }
-    static inline void write_to(uint64_t* dest) {
-        *dest = n;
-        T::write_to(dest + 1);
+    static inline std::string hex(void) {
+        return HexRepresentation<BigUnsigned>::str();
+    }
+    static constexpr const char* bin_c_str(void) {
+        return BinaryRepresentation<BigUnsigned>::c_str();
+    }
+    static constexpr const char* dec_c_str(void) {
+        return DecimalRepresentation<BigUnsigned>::c_str();
+    }
+    static constexpr const char* hex_c_str(void) {
+        return HexRepresentation<BigUnsigned>::c_str();
+    }
+#if __cplusplus >= 201703L
+    static constexpr std::string_view bin_view(void) {
+        return BinaryRepresentation<BigUnsigned>::view();
+    }
+    static constexpr std::string_view dec_view(void) {
+        return DecimalRepresentation<BigUnsigned>::view();
+    }
+    static constexpr std::string_view hex_view(void) {
+        return HexRepresentation<BigUnsigned>::view();
+    }
+#endif
+    // the digits, least significant first, as one 64-byte aligned array
+    static constexpr const word* data(void) {
+        return WordArray<BigUnsigned>::value;
+    }
+    // rounded to nearest, ties to even
+    static constexpr double to_double(void) {
+        return FloatingValue<BigUnsigned, double>::value;
+    }
+    static constexpr long double to_long_double(void) {
+        return FloatingValue<BigUnsigned, long double>::value;
+    }
+    static inline void write_to(word* dest) {
+        std::memcpy(dest, data(), length * sizeof(word));
+    }
+    // the digits cut into length_in<Limb>() limbs of another width
+    template<class Limb>
+    static inline void write_to(Limb* dest) {
+        std::memcpy(dest, LimbArray<BigUnsigned, Limb>::value, length_in<Limb>() * sizeof(Limb));
     }
-    static inline uint64_t get_digit(size_t which) {
-        return which == 0 ? n : T::get_digit(which - 1);
+    template<class Limb>
+    static constexpr size_t length_in(void) {
+        return (length * word_bits + 8 * sizeof(Limb) - 1) / (8 * sizeof(Limb));
+    }
+    // sizeof(word) * length bytes, least or most significant first
+    static inline void to_bytes_le(uint8_t* dest) {
+        std::memcpy(dest, ByteArray<BigUnsigned, false>::value, length * sizeof(word));
+    }
+    static inline void to_bytes_be(uint8_t* dest) {
+        std::memcpy(dest, ByteArray<BigUnsigned, true>::value, length * sizeof(word));
+    }
+    static constexpr word get_digit(size_t which) {
+        return which < length ? data()[which] : 0;
     }
 };
 
@@ -67,7 +202,7 @@ struct Optimize<BigUnsigned<0, Zero>> {
     using Result = Zero;
 };
 
-template<uint64_t n, class T>
+template<word n, class T>
 struct Optimize<BigUnsigned<n, T>> {
 private:
     using Tail = typename Optimize<T>::Result;
@@ -79,11 +214,288 @@ public:
     >::type;
 };
 
-#define BIGUNSIGNED_1(x1) typename static_bignum::Optimize<static_bignum::BigUnsigned<(x1)>>::Result
-//#define BIGUNSIGNED_1(x1)         static_bignum::BigUnsigned<(x1), static_bignum::NoneType>
-#define BIGUNSIGNED_2(x1, x2)         static_bignum::BigUnsigned<(x2), BIGUNSIGNED_1((x1))>
-#define BIGUNSIGNED_3(x1, x2, x3)     static_bignum::BigUnsigned<(x3), BIGUNSIGNED_2((x2), (x1))>
-#define BIGUNSIGNED_4(x1, x2, x3, x4) static_bignum::BigUnsigned<(x4), BIGUNSIGNED_3((x3), (x2), (x1))>
+// BigUnsigned<n, T> for an already optimized T, collapsing to Zero when
+// there are no nonzero digits left; unlike Optimize it does not recurse
+template<word n, class T> struct Prepend { using Result = BigUnsigned<n, T>; };
+template<> struct Prepend<0, Zero> { using Result = Zero; };
+
+// true if A has no leading zero words; every operation returns such numbers
+template<class A> struct IsCanonical { static const bool value = true; };
+template<word n> struct IsCanonical<BigUnsigned<n, Zero>> { static const bool value = n != 0; };
+template<word n, class T> struct IsCanonical<BigUnsigned<n, T>> : IsCanonical<T> {};
+
+// with STATIC_BIGNUM_CHECK_CANONICAL defined, results of every operation are
+// checked and a non-canonical one fails compilation naming the operation
+#ifdef STATIC_BIGNUM_CHECK_CANONICAL
+#define STATIC_BIGNUM_ASSERT_CANONICAL(X, operation) \
+    static_assert(static_bignum::IsCanonical<X>::value, operation " returned a number with leading zero words")
+#else
+#define STATIC_BIGNUM_ASSERT_CANONICAL(X, operation) static_assert(true, "")
+#endif
+
+// Compile-time cost model: every operation has cost, the number of
+// operation templates instantiated to compute it, itself included and
+// shared subresults counted once per use, and depth, how deeply those
+// instantiations nest, which is what -ftemplate-depth limits. Digit access,
+// comparisons and constexpr helpers are not counted, and an operation the
+// constexpr backend or FlatUnsigned computes with constexpr functions costs
+// 1. STATIC_BIGNUM_COST(Sub...) declares both for an operation that
+// instantiates the operations Sub...
+constexpr size_t sum_of(void) { return 0; }
+template<class... T>
+constexpr size_t sum_of(size_t x, T... rest) { return x + sum_of(rest...); }
+
+constexpr size_t max_of(void) { return 0; }
+constexpr size_t max_of(size_t x) { return x; }
+constexpr size_t max_of(size_t x, size_t y) { return x > y ? x : y; }
+template<class... T>
+constexpr size_t max_of(size_t x, size_t y, T... rest) { return max_of(max_of(x, y), rest...); }
+
+template<class... Sub>
+constexpr size_t total_cost(void) { return sum_of(Sub::cost...); }
+template<class... Sub>
+constexpr size_t max_depth(void) { return max_of(Sub::depth...); }
+
+#define STATIC_BIGNUM_COST(...) \
+    static const size_t cost  = 1 + static_bignum::total_cost<__VA_ARGS__>(); \
+    static const size_t depth = 1 + static_bignum::max_depth<__VA_ARGS__>()
+
+// with STATIC_BIGNUM_BUDGET defined to a number, an operation whose cost
+// exceeds it fails compilation naming the operation, so that a change making
+// some expression much more expensive to compile does not go unnoticed
+#ifdef STATIC_BIGNUM_BUDGET
+#define STATIC_BIGNUM_ASSERT_BUDGET(X, operation) \
+    static_assert(X::cost <= STATIC_BIGNUM_BUDGET, operation " instantiates more templates than STATIC_BIGNUM_BUDGET allows")
+#else
+#define STATIC_BIGNUM_ASSERT_BUDGET(X, operation) static_assert(true, "")
+#endif
+
+template<size_t... i> struct IndexSequence {};
+
+template<class A, class B> struct ConcatIndexSequences;
+template<size_t... a, size_t... b>
+struct ConcatIndexSequences<IndexSequence<a...>, IndexSequence<b...>> {
+    using Result = IndexSequence<a..., (sizeof...(a) + b)...>;
+};
+
+// IndexSequence<0, ..., n - 1> with logarithmic recursion depth
+template<size_t n>
+struct MakeIndexSequence {
+    using Result = typename ConcatIndexSequences<
+        typename MakeIndexSequence<n / 2>::Result,
+        typename MakeIndexSequence<n - n / 2>::Result
+    >::Result;
+};
+template<> struct MakeIndexSequence<0> { using Result = IndexSequence<>; };
+template<> struct MakeIndexSequence<1> { using Result = IndexSequence<0>; };
+
+// digits of A, least significant first, followed by a zero word; a single
+// cache line aligned array in read-only data for every number
+template<word... digits>
+struct WordArray<Zero, digits...> {
+    alignas(64) static constexpr word value[] = {digits..., 0};
+};
+
+template<word... digits>
+alignas(64) constexpr word WordArray<Zero, digits...>::value[];
+
+template<word n, class T, word... digits>
+struct WordArray<BigUnsigned<n, T>, digits...> : WordArray<T, digits..., n> {};
+
+constexpr const word* Zero::data(void) {
+    return WordArray<Zero>::value;
+}
+
+template<class A, bool big_endian, class I> struct ByteArrayImplementation;
+
+template<class A, bool big_endian, size_t... i>
+struct ByteArrayImplementation<A, big_endian, IndexSequence<i...>> {
+    static constexpr uint8_t at(size_t k) {
+        return static_cast<uint8_t>(big_endian
+            ? A::data()[A::length - 1 - k / sizeof(word)] >> (word_bits - 8 - 8 * (k % sizeof(word)))
+            : A::data()[k / sizeof(word)] >> (8 * (k % sizeof(word))));
+    }
+    alignas(64) static constexpr uint8_t value[] = {at(i)..., 0};
+};
+
+template<class A, bool big_endian, size_t... i>
+alignas(64) constexpr uint8_t ByteArrayImplementation<A, big_endian, IndexSequence<i...>>::value[];
+
+// bytes of A::data(), least or most significant first, followed by a zero byte
+template<class A, bool big_endian>
+struct ByteArray : ByteArrayImplementation<
+    A, big_endian, typename MakeIndexSequence<sizeof(word) * A::length>::Result> {};
+
+// digits 0 .. size - 1 of A padded with zero words, plus one more zero word
+template<class A, size_t size, class I = typename MakeIndexSequence<size>::Result>
+struct PaddedWordArray;
+
+template<class A, size_t size, size_t... i>
+struct PaddedWordArray<A, size, IndexSequence<i...>> {
+    alignas(64) static constexpr word value[] = {A::get_digit(i)..., 0};
+};
+
+template<class A, size_t size, size_t... i>
+alignas(64) constexpr word PaddedWordArray<A, size, IndexSequence<i...>>::value[];
+
+// limb i of A for limbs of 8 * sizeof(Limb) bits, k words of A into it
+template<class A, class Limb>
+constexpr Limb limb_digit(size_t i, size_t k = 0) {
+    return 8 * sizeof(Limb) <= word_bits
+        ? static_cast<Limb>(A::get_digit(i * 8 * sizeof(Limb) / word_bits) >> (i * 8 * sizeof(Limb) % word_bits))
+        : k == 8 * sizeof(Limb) / word_bits ? 0
+        : static_cast<Limb>(static_cast<Limb>(A::get_digit(i * (8 * sizeof(Limb) / word_bits) + k)) << (k * word_bits))
+            | limb_digit<A, Limb>(i, k + 1);
+}
+
+template<class A, class Limb, class I> struct LimbArrayImplementation;
+
+template<class A, class Limb, size_t... i>
+struct LimbArrayImplementation<A, Limb, IndexSequence<i...>> {
+    static_assert(static_cast<Limb>(-1) > 0, "limbs must be unsigned");
+    alignas(64) static constexpr Limb value[] = {limb_digit<A, Limb>(i)..., 0};
+};
+
+template<class A, class Limb, size_t... i>
+alignas(64) constexpr Limb LimbArrayImplementation<A, Limb, IndexSequence<i...>>::value[];
+
+// A::length_in<Limb>() limbs of A, least significant first, followed by a zero limb
+template<class A, class Limb>
+struct LimbArray : LimbArrayImplementation<
+    A, Limb, typename MakeIndexSequence<A::template length_in<Limb>()>::Result> {};
+
+// digits, least significant first -> optimized BigUnsigned
+template<word... digits> struct PackWords;
+
+template<>
+struct PackWords<> { using Result = Zero; };
+
+template<word n, word... digits>
+struct PackWords<n, digits...> {
+    using Result = typename Prepend<n, typename PackWords<digits...>::Result>::Result;
+};
+
+// 64-bit digits, least significant first -> optimized BigUnsigned of words
+#if STATIC_BIGNUM_LIMB_BITS == 64
+template<uint64_t... digits> struct PackWords64 : PackWords<digits...> {};
+#else
+template<uint64_t... digits> struct PackWords64;
+
+template<>
+struct PackWords64<> { using Result = Zero; };
+#endif
+
+#if STATIC_BIGNUM_LIMB_BITS == 32
+template<uint64_t n, uint64_t... digits>
+struct PackWords64<n, digits...> {
+    using Result = typename Prepend<static_cast<word>(n), typename Prepend<
+        static_cast<word>(n >> 32), typename PackWords64<digits...>::Result
+    >::Result>::Result;
+};
+#elif STATIC_BIGNUM_LIMB_BITS == 128
+template<uint64_t n>
+struct PackWords64<n> { using Result = typename Prepend<n, Zero>::Result; };
+
+template<uint64_t n, uint64_t m, uint64_t... digits>
+struct PackWords64<n, m, digits...> {
+    using Result = typename Prepend<
+        (static_cast<word>(m) << 64) | n, typename PackWords64<digits...>::Result
+    >::Result;
+};
+#endif
+
+// the arguments are 64-bit digits whatever the word size
+#define BIGUNSIGNED_1(x1)             typename static_bignum::PackWords64<(x1)>::Result
+#define BIGUNSIGNED_2(x1, x2)         typename static_bignum::PackWords64<(x2), (x1)>::Result
+#define BIGUNSIGNED_3(x1, x2, x3)     typename static_bignum::PackWords64<(x3), (x2), (x1)>::Result
+#define BIGUNSIGNED_4(x1, x2, x3, x4) typename static_bignum::PackWords64<(x4), (x3), (x2), (x1)>::Result
+
+///////////////////////////////////////////////////////////////////////////
+///////////////////////////// word arithmetic /////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// Products of two words and quotients of two words by one: through a
+// double-width type where there is one (uint64_t for 32-bit words, unsigned
+// __int128 for 64-bit words), in half words otherwise.
+
+#if STATIC_BIGNUM_LIMB_BITS == 32
+#define STATIC_BIGNUM_DOUBLE_WORD uint64_t
+#elif STATIC_BIGNUM_LIMB_BITS == 64 && defined(__SIZEOF_INT128__)
+#define STATIC_BIGNUM_DOUBLE_WORD uint128_t
+#endif
+
+constexpr word mul_lo(word a, word b) {
+    return a * b;
+}
+
+#ifdef STATIC_BIGNUM_DOUBLE_WORD
+using double_word = STATIC_BIGNUM_DOUBLE_WORD;
+
+constexpr word mul_hi(word a, word b) {
+    return static_cast<word>((static_cast<double_word>(a) * b) >> word_bits);
+}
+#else
+constexpr word lo_half(word x) { return x & (word_max >> word_bits / 2); }
+constexpr word hi_half(word x) { return x >> word_bits / 2; }
+
+constexpr word mul_mid(word a, word b) {
+    return hi_half(lo_half(a) * lo_half(b)) + lo_half(hi_half(a) * lo_half(b))
+         + lo_half(lo_half(a) * hi_half(b));
+}
+
+constexpr word mul_hi(word a, word b) {
+    return hi_half(a) * hi_half(b) + hi_half(hi_half(a) * lo_half(b))
+         + hi_half(lo_half(a) * hi_half(b)) + hi_half(mul_mid(a, b));
+}
+#endif
+
+// (hi * 2 ** word_bits + lo) / d and (hi * 2 ** word_bits + lo) % d for
+// hi < d, so that the quotient fits into a single word. Without a double
+// width type this is restoring division, one bit of lo per step.
+
+#ifdef STATIC_BIGNUM_DOUBLE_WORD
+constexpr word div_word(word hi, word lo, word d) {
+    return static_cast<word>(((static_cast<double_word>(hi) << word_bits) | lo) / d);
+}
+
+constexpr word mod_word(word hi, word lo, word d) {
+    return static_cast<word>(((static_cast<double_word>(hi) << word_bits) | lo) % d);
+}
+#else
+constexpr word div_shifted(word r, word lo, int i) {
+    return (r << 1) | ((lo >> i) & 1);
+}
+
+constexpr bool div_takes(word r, word lo, word d, int i) {
+    return (r >> (word_bits - 1)) != 0 || div_shifted(r, lo, i) >= d;
+}
+
+constexpr word div_next(word r, word lo, word d, int i) {
+    return div_takes(r, lo, d, i) ? div_shifted(r, lo, i) - d : div_shifted(r, lo, i);
+}
+
+constexpr word div_quotient(word r, word lo, word d, int i, word q) {
+    return i < 0 ? q : div_quotient(
+        div_next(r, lo, d, i), lo, d, i - 1, (q << 1) | (div_takes(r, lo, d, i) ? 1 : 0));
+}
+
+constexpr word div_residue(word r, word lo, word d, int i) {
+    return i < 0 ? r : div_residue(div_next(r, lo, d, i), lo, d, i - 1);
+}
+
+constexpr word div_word(word hi, word lo, word d) {
+    return div_quotient(hi, lo, d, word_bits - 1, 0);
+}
+
+constexpr word mod_word(word hi, word lo, word d) {
+    return div_residue(hi, lo, d, word_bits - 1);
+}
+#endif
+
+constexpr int leading_zeros(word x, int count = 0) {
+    return x == 0 ? static_cast<int>(word_bits)
+         : (x >> (word_bits - 1)) != 0 ? count : leading_zeros(x << 1, count + 1);
+}
 
 ///////////////////////////////////////////////////////////////////////////
 //////////////////////////////// addition /////////////////////////////////
@@ -91,22 +503,35 @@ public:
 
 template<class A, class B> struct Sum;
 
-template<> struct Sum<Zero, Zero> { using Result = Zero; };
+template<> struct Sum<Zero, Zero> { using Result = Zero; STATIC_BIGNUM_COST(); };
 
-template<uint64_t n, class T>
-struct Sum<Zero, BigUnsigned<n, T>> { using Result = BigUnsigned<n, T>; };
+template<word n, class T>
+struct Sum<Zero, BigUnsigned<n, T>> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
 
-template<uint64_t n, class T>
-struct Sum<BigUnsigned<n, T>, Zero> { using Result = BigUnsigned<n, T>; };
+template<word n, class T>
+struct Sum<BigUnsigned<n, T>, Zero> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
 
-template<uint64_t a_n, uint64_t b_n, class a_T, class b_T>
+#ifdef STATIC_BIGNUM_CONSTEXPR_BACKEND
+template<word a_n, word b_n, class a_T, class b_T>
+struct Sum<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T> >
+    : ConstexprSum<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
+    STATIC_BIGNUM_ASSERT_CANONICAL(typename Sum::Result, "Sum");
+    STATIC_BIGNUM_COST();
+};
+#else
+template<word a_n, word b_n, class a_T, class b_T>
 struct Sum<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T> > {
-    static const uint64_t carry = b_n > UINT64_MAX - a_n ? 1 : 0;
-    using Result = BigUnsigned<a_n + b_n, typename Sum<
-        typename Sum<a_T, b_T>::Result,
-        BIGUNSIGNED_1(carry)
-    >::Result>;
+    static const word carry = b_n > word_max - a_n ? 1 : 0;
+private:
+    using Tail = Sum<a_T, b_T>;
+    using Carry = Sum<typename Tail::Result, typename Prepend<carry, Zero>::Result>;
+public:
+    using Result = BigUnsigned<a_n + b_n, typename Carry::Result>;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "Sum");
+    STATIC_BIGNUM_COST(Tail, Carry);
+    STATIC_BIGNUM_ASSERT_BUDGET(Sum, "Sum");
 };
+#endif
 
 #ifdef STATIC_BIGNUM_USE_MACRO
 #define SBN_SUM(x, y) static_bignum::Sum<x, y>::Result
@@ -118,18 +543,26 @@ struct Sum<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T> > {
 
 template<class A, class B> struct Difference;
 
-template<> struct Difference<Zero, Zero> { using Result = Zero; };
+template<> struct Difference<Zero, Zero> { using Result = Zero; STATIC_BIGNUM_COST(); };
 
-template<uint64_t n, class T>
-struct Difference<BigUnsigned<n, T>, Zero> { using Result = BigUnsigned<n, T>; };
+template<word n, class T>
+struct Difference<BigUnsigned<n, T>, Zero> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
 
-template<uint64_t n, class T>
-struct Difference<Zero, BigUnsigned<n, T>> { using Result = ErrorType; };
+template<word n, class T>
+struct Difference<Zero, BigUnsigned<n, T>> { using Result = ErrorType; STATIC_BIGNUM_COST(); };
 
-template<class A> struct Difference<ErrorType, A> { using Result = ErrorType; };
-template<class A> struct Difference<A, ErrorType> { using Result = ErrorType; };
+template<class A> struct Difference<ErrorType, A> { using Result = ErrorType; STATIC_BIGNUM_COST(); };
+template<class A> struct Difference<A, ErrorType> { using Result = ErrorType; STATIC_BIGNUM_COST(); };
 
-template<uint64_t a_n, uint64_t b_n, class a_T, class b_T>
+#ifdef STATIC_BIGNUM_CONSTEXPR_BACKEND
+template<word a_n, word b_n, class a_T, class b_T>
+struct Difference<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T> >
+    : ConstexprDifference<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
+    STATIC_BIGNUM_ASSERT_CANONICAL(typename Difference::Result, "Difference");
+    STATIC_BIGNUM_COST();
+};
+#else
+template<word a_n, word b_n, class a_T, class b_T>
 struct Difference<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T> > {
     using A = BigUnsigned<a_n, a_T>;
     using B = BigUnsigned<b_n, b_T>;
@@ -137,14 +570,15 @@ struct Difference<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T> > {
     using Result_T = typename std::conditional< // deciding whether carry or not
         a_n >= b_n, C, typename Difference<C, One>::Result
     >::type;
-//     static const uint64_t Result_n = // it will be done automatically
-//         a_n >= b_n ? (a_n - b_n) : ((UINT64_MAX - b_n) + (a_n + 1));
-    using Result = typename std::conditional< // removing trailing zeros // TODO Optimize
-        a_n == b_n && std::is_same<Result_T, Zero>::value,
-        Zero,
-        BigUnsigned<a_n - b_n, Result_T>
-    >::type;
+    STATIC_BIGNUM_COST(Difference<a_T, b_T>, Difference<C, One>);
+    STATIC_BIGNUM_ASSERT_BUDGET(Difference, "Difference");
+//     static const word Result_n = // it will be done automatically
+//         a_n >= b_n ? (a_n - b_n) : ((word_max - b_n) + (a_n + 1));
+    // Result_T is already canonical, so only this word may be a leading zero
+    using Result = typename Prepend<a_n - b_n, Result_T>::Result;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "Difference");
 };
+#endif
 
 #ifdef STATIC_BIGNUM_USE_MACRO
 #define SBN_DIFF(x, y) static_bignum::Difference<x, y>::Result
@@ -154,87 +588,121 @@ struct Difference<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T> > {
 ////////////////////////////////// shift //////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////
 
-// FIXME left shift by 193 turns 1-word integer into 8-word, by 129 --
-//       into 6-word if applying BigShiftLeft before SmallShiftLeft
+// Big shifts move whole words, small shifts move bits within words and pass
+// the bits shifted out on to the neighbouring word instead of adding them,
+// so no shift produces leading zero words.
 
 template<class A, size_t shift> struct BigShiftLeft;
 template<class A, size_t shift> struct BigShiftRight;
-template<class A, size_t shift> struct SmallShiftLeft;
+template<class A, size_t shift, word carry = 0> struct SmallShiftLeft;
 template<class A, size_t shift> struct SmallShiftRight;
 
 
-template<size_t shift> struct BigShiftLeft   <Zero, shift> { using Result = Zero; };
-template<size_t shift> struct BigShiftRight  <Zero, shift> { using Result = Zero; };
-template<size_t shift> struct SmallShiftLeft <Zero, shift> { using Result = Zero; };
+template<size_t shift> struct BigShiftLeft   <Zero, shift> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<size_t shift> struct BigShiftRight  <Zero, shift> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<size_t shift, word carry>
+struct SmallShiftLeft<Zero, shift, carry> {
+    using Result = typename Prepend<carry, Zero>::Result;
+    STATIC_BIGNUM_COST();
+};
 template<size_t shift> struct SmallShiftRight<Zero, shift> {
-    static const uint64_t carry = 0;
+    static const word carry = 0;
     using Result = Zero;
+    STATIC_BIGNUM_COST();
 };
 
-template<uint64_t n, class T, size_t shift>
+template<word n, class T, size_t shift>
 struct BigShiftLeft<BigUnsigned<n, T>, shift> {
     using Argument = BigUnsigned<n, T>;
-    using Result   = BigUnsigned<0ULL, typename BigShiftLeft<Argument, shift-1>::Result>;
+    using Result   = BigUnsigned<0, typename BigShiftLeft<Argument, shift-1>::Result>;
+    STATIC_BIGNUM_COST(BigShiftLeft<Argument, shift-1>);
 };
-template<uint64_t n, class T, size_t shift>
-struct SmallShiftLeft<BigUnsigned<n, T>, shift> {
-    static_assert(shift < 64, "shift in SmallShiftLeft must be less than 64 bits");
-    static const uint64_t carry = n >> (64 - shift);
+// A << shift | carry
+template<word n, class T, size_t shift, word carry>
+struct SmallShiftLeft<BigUnsigned<n, T>, shift, carry> {
+    static_assert(shift < word_bits, "shift in SmallShiftLeft must be shorter than a word");
     using Result = BigUnsigned<
-        n << shift,
-        typename Sum<
-            typename SmallShiftLeft<T, shift>::Result,
-            BIGUNSIGNED_1(carry)
-        >::Result
+        (n << shift) | carry,
+        typename SmallShiftLeft<T, shift, (n >> (word_bits - shift))>::Result
     >;
+    STATIC_BIGNUM_COST(SmallShiftLeft<T, shift, (n >> (word_bits - shift))>);
 };
 
-template<uint64_t n, class T, size_t shift>
+template<word n, class T, size_t shift>
 struct BigShiftRight<BigUnsigned<n, T>, shift> {
     using Argument = BigUnsigned<n, T>;
     using Result   = typename BigShiftRight<T, shift-1>::Result;
+    STATIC_BIGNUM_COST(BigShiftRight<T, shift-1>);
 };
-template<uint64_t n, class T, size_t shift>
+template<word n, class T, size_t shift>
 struct SmallShiftRight<BigUnsigned<n, T>, shift> {
-    static_assert(shift < 64, "shift in SmallShiftRight must be less than 64 bits");
-    static const uint64_t carry = n << (64 - shift);
-    using Result = BigUnsigned<
+    static_assert(shift < word_bits, "shift in SmallShiftRight must be shorter than a word");
+    static const word carry = n << (word_bits - shift);
+    using Result = typename Prepend<
         (n >> shift) | SmallShiftRight<T, shift>::carry,
         typename SmallShiftRight<T, shift>::Result
-    >;
+    >::Result;
+    STATIC_BIGNUM_COST(SmallShiftRight<T, shift>);
 };
 
-template<uint64_t n, class T>
-struct BigShiftLeft   <BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; };
-template<uint64_t n, class T>
-struct BigShiftRight  <BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; };
-template<uint64_t n, class T>
-struct SmallShiftLeft <BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; };
-template<uint64_t n, class T>
+template<word n, class T>
+struct BigShiftLeft   <BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct BigShiftRight  <BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct SmallShiftLeft <BigUnsigned<n, T>, 0, 0> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
+template<word n, class T>
 struct SmallShiftRight<BigUnsigned<n, T>, 0> {
-    static const uint64_t carry = 0;
+    static const word carry = 0;
     using Result = BigUnsigned<n, T>;
+    STATIC_BIGNUM_COST();
 };
 
+#ifdef STATIC_BIGNUM_CONSTEXPR_BACKEND
+template<class A, size_t shift>
+struct ShiftLeft : ConstexprShiftLeft<A, shift> {
+    STATIC_BIGNUM_ASSERT_CANONICAL(typename ShiftLeft::Result, "ShiftLeft");
+    STATIC_BIGNUM_COST();
+};
+#else
 template<class A, size_t shift>
 struct ShiftLeft {
-    using Result = typename BigShiftLeft<
-        typename SmallShiftLeft<A, shift % 64>::Result, shift / 64
-    >::Result;
+private:
+    using Small = SmallShiftLeft<A, shift % word_bits>;
+    using Big = BigShiftLeft<typename Small::Result, shift / word_bits>;
+public:
+    using Result = typename Big::Result;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "ShiftLeft");
+    STATIC_BIGNUM_COST(Small, Big);
+    STATIC_BIGNUM_ASSERT_BUDGET(ShiftLeft, "ShiftLeft");
 };
-template<size_t shift> struct ShiftLeft<Zero, shift> { using Result = Zero; };
-template<uint64_t n, class T>
-struct ShiftLeft<BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; };
+#endif
+template<size_t shift> struct ShiftLeft<Zero, shift> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct ShiftLeft<BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
 
+#ifdef STATIC_BIGNUM_CONSTEXPR_BACKEND
+template<class A, size_t shift>
+struct ShiftRight : ConstexprShiftRight<A, shift> {
+    STATIC_BIGNUM_ASSERT_CANONICAL(typename ShiftRight::Result, "ShiftRight");
+    STATIC_BIGNUM_COST();
+};
+#else
 template<class A, size_t shift>
 struct ShiftRight {
-    using Result = typename SmallShiftRight<
-        typename BigShiftRight<A, shift / 64>::Result, shift % 64
-    >::Result;
+private:
+    using Big = BigShiftRight<A, shift / word_bits>;
+    using Small = SmallShiftRight<typename Big::Result, shift % word_bits>;
+public:
+    using Result = typename Small::Result;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "ShiftRight");
+    STATIC_BIGNUM_COST(Big, Small);
+    STATIC_BIGNUM_ASSERT_BUDGET(ShiftRight, "ShiftRight");
 };
-template<size_t shift> struct ShiftRight<Zero, shift> { using Result = Zero; };
-template<uint64_t n, class T>
-struct ShiftRight<BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; };
+#endif
+template<size_t shift> struct ShiftRight<Zero, shift> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct ShiftRight<BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
 
 #ifdef STATIC_BIGNUM_USE_MACRO
 #define SBN_SHL(x, y) static_bignum::ShiftLeft <x, y>::Result
@@ -248,36 +716,149 @@ struct ShiftRight<BigUnsigned<n, T>, 0> { using Result = BigUnsigned<n, T>; };
 
 template<class A, class B> struct Product;
 
-template<> struct Product<Zero, Zero>     { using Result = Zero; };
-template<> struct Product<Zero, One>      { using Result = Zero; };
-template<> struct Product<One, Zero>      { using Result = Zero; };
-template<> struct Product<One, One>       { using Result = One;  };
-template<uint64_t n, class T> struct Product<Zero, BigUnsigned<n, T>> { using Result = Zero; };
-template<uint64_t n, class T> struct Product<BigUnsigned<n, T>, Zero> { using Result = Zero; };
-template<uint64_t n, class T> struct Product<BigUnsigned<n, T>, One>  { using Result = BigUnsigned<n, T>; };
-template<uint64_t n, class T> struct Product<One, BigUnsigned<n, T>>  { using Result = BigUnsigned<n, T>; };
+template<> struct Product<Zero, Zero>     { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<> struct Product<Zero, One>      { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<> struct Product<One, Zero>      { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<> struct Product<One, One>       { using Result = One;  STATIC_BIGNUM_COST(); };
+template<word n, class T> struct Product<Zero, BigUnsigned<n, T>> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T> struct Product<BigUnsigned<n, T>, Zero> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T> struct Product<BigUnsigned<n, T>, One>  { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
+template<word n, class T> struct Product<One, BigUnsigned<n, T>>  { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
+
+// A * w + carry, one instantiation per word of A
+template<class A, word w, word carry = 0> struct ProductByWord;
+
+template<word w, word carry>
+struct ProductByWord<Zero, w, carry> {
+    using Result = typename Prepend<carry, Zero>::Result;
+    STATIC_BIGNUM_COST();
+};
+
+template<word n, class T>
+struct ProductByWord<BigUnsigned<n, T>, 0, 0> { using Result = Zero; STATIC_BIGNUM_COST(); };
+
+template<word n, class T, word w, word carry>
+struct ProductByWord<BigUnsigned<n, T>, w, carry> {
+    static const word low  = mul_lo(n, w) + carry;
+    static const word high = mul_hi(n, w) + (low < carry ? 1 : 0);
+    using Result = BigUnsigned<low, typename ProductByWord<T, w, high>::Result>;
+    STATIC_BIGNUM_COST(ProductByWord<T, w, high>);
+};
+
+// lowest k words of A
+template<class A, size_t k> struct LowWords;
+template<size_t k> struct LowWords<Zero, k> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T> struct LowWords<BigUnsigned<n, T>, 0> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T, size_t k>
+struct LowWords<BigUnsigned<n, T>, k> {
+    using Result = typename Prepend<n, typename LowWords<T, k - 1>::Result>::Result;
+    STATIC_BIGNUM_COST(LowWords<T, k - 1>);
+};
+
+// C + A * w + carry in one pass over the words of A and C
+template<class C, class A, word w, word carry = 0> struct AddProductByWord;
+
+template<word w, word carry>
+struct AddProductByWord<Zero, Zero, w, carry> {
+    using Result = typename Prepend<carry, Zero>::Result;
+    STATIC_BIGNUM_COST();
+};
+
+template<word a_n, class a_T, word w, word carry>
+struct AddProductByWord<Zero, BigUnsigned<a_n, a_T>, w, carry>
+    : ProductByWord<BigUnsigned<a_n, a_T>, w, carry> {};
+
+template<word c_n, class c_T, word w, word carry>
+struct AddProductByWord<BigUnsigned<c_n, c_T>, Zero, w, carry>
+    : ProductByWord<BigUnsigned<c_n, c_T>, 1, carry> {};
+
+template<word c_n, class c_T, word a_n, class a_T, word w, word carry>
+struct AddProductByWord<BigUnsigned<c_n, c_T>, BigUnsigned<a_n, a_T>, w, carry> {
+private:
+    static const word partial = mul_lo(a_n, w) + c_n;
+    static const word low     = partial + carry;
+    // a_n * w + c_n + carry < P ** 2, so the high word does not overflow
+    static const word high    = mul_hi(a_n, w) + (partial < c_n ? 1 : 0) + (low < carry ? 1 : 0);
+public:
+    using Result = typename Prepend<low, typename AddProductByWord<c_T, a_T, w, high>::Result>::Result;
+    STATIC_BIGNUM_COST(AddProductByWord<c_T, a_T, w, high>);
+};
+
+// A * B + C, accumulating one row A * b_n per word of B into C and emitting
+// the lowest word of the accumulator after each row
+template<class A, class B, class C> struct MulAdd;
+
+template<class A, class C>
+struct MulAdd<A, Zero, C> { using Result = C; STATIC_BIGNUM_COST(); };
+
+template<class A, word b_n, class b_T, class C>
+struct MulAdd<A, BigUnsigned<b_n, b_T>, C> {
+private:
+    using Row = AddProductByWord<C, A, b_n>;
+    using Shift = BigShiftRight<typename Row::Result, 1>;
+    using Next = MulAdd<A, b_T, typename Shift::Result>;
+public:
+    using Result = typename Prepend<Row::Result::digit, typename Next::Result>::Result;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "MulAdd");
+    STATIC_BIGNUM_COST(Row, Shift, Next);
+};
+
+// a * (b_n + P * b_T) = a * b_n + P * (a * b_T), P = 2 ** word_bits
+template<class A, class B>
+struct SchoolbookProduct : MulAdd<A, B, Zero> {};
+
+#ifndef STATIC_BIGNUM_KARATSUBA_THRESHOLD
+#define STATIC_BIGNUM_KARATSUBA_THRESHOLD 8
+#endif
+
+// a * b = P ** 2k * a1 * b1
+//       + P ** k  * ((a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1)
+//       +           a0 * b0,                                 P = 2 ** word_bits
+template<class A, class B>
+struct KaratsubaProduct {
+private:
+    static const size_t k = (A::length < B::length ? A::length : B::length) / 2;
+    using A0 = typename LowWords<A, k>::Result;
+    using A1 = typename BigShiftRight<A, k>::Result;
+    using B0 = typename LowWords<B, k>::Result;
+    using B1 = typename BigShiftRight<B, k>::Result;
+    using Z0 = typename Product<A0, B0>::Result;
+    using Z2 = typename Product<A1, B1>::Result;
+    using SumA = Sum<A0, A1>;
+    using SumB = Sum<B0, B1>;
+    using Z = Product<typename SumA::Result, typename SumB::Result>;
+    using ZZ0 = Difference<typename Z::Result, Z0>;
+    using Z1 = typename Difference<typename ZZ0::Result, Z2>::Result;
+    using High = Sum<typename BigShiftLeft<Z2, 2 * k>::Result, typename BigShiftLeft<Z1, k>::Result>;
+public:
+    using Result = typename Sum<typename High::Result, Z0>::Result;
+    STATIC_BIGNUM_COST(
+        LowWords<A, k>, BigShiftRight<A, k>, LowWords<B, k>, BigShiftRight<B, k>,
+        Product<A0, B0>, Product<A1, B1>, SumA, SumB, Z, ZZ0, Difference<typename ZZ0::Result, Z2>,
+        BigShiftLeft<Z2, 2 * k>, BigShiftLeft<Z1, k>, High, Sum<typename High::Result, Z0>);
+};
 
-template<uint64_t a_n, uint64_t b_n, class a_T, class b_T>
+template<word a_n, word b_n, class a_T, class b_T>
 struct Product<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T> > {
-    // a * b = P ** 2 * (a / P) * (b / P)
-    //       +          (a % P) * (b % P)
-    //       + P      * (a % P) * (b / P)
-    //       + P      * (a / P) * (b % P)
     using A = BigUnsigned<a_n, a_T>;
     using B = BigUnsigned<b_n, b_T>;
-    using Adiv2 = typename Optimize<typename SmallShiftRight<A, 1>::Result>::Result;
-    using Bdiv2 = typename Optimize<typename SmallShiftRight<B, 1>::Result>::Result;
-    using Amod2 = BIGUNSIGNED_1(a_n & 1);
-    using Bmod2 = BIGUNSIGNED_1(b_n & 1);
-    using Result = typename Sum<
-        typename Sum<
-            typename SmallShiftLeft<typename Product<Adiv2, Bdiv2>::Result, 2>::Result,
-            BIGUNSIGNED_1((a_n & 1) * (b_n & 1))
-        >::Result, typename Sum<
-            typename SmallShiftLeft<typename Product<Adiv2, Bmod2>::Result, 1>::Result,
-            typename SmallShiftLeft<typename Product<Amod2, Bdiv2>::Result, 1>::Result
-        >::Result
-    >::Result;
+#ifdef STATIC_BIGNUM_CONSTEXPR_BACKEND
+    using Result = typename ConstexprProduct<A, B>::Result;
+    STATIC_BIGNUM_COST();
+#else
+private:
+    using Algorithm = typename std::conditional<
+        A::length >= STATIC_BIGNUM_KARATSUBA_THRESHOLD &&
+        B::length >= STATIC_BIGNUM_KARATSUBA_THRESHOLD,
+        KaratsubaProduct<A, B>,
+        SchoolbookProduct<A, B>
+    >::type;
+public:
+    using Result = typename Algorithm::Result;
+    STATIC_BIGNUM_COST(Algorithm);
+#endif
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "Product");
+    STATIC_BIGNUM_ASSERT_BUDGET(Product, "Product");
 };
 
 #ifdef STATIC_BIGNUM_USE_MACRO
@@ -295,24 +876,24 @@ template<class A> struct GreaterThan<Zero, A>          { static const bool value
 template<class A> struct GreaterThanOrEqualTo<Zero, A> { static const bool value = false; };
 template<> struct GreaterThanOrEqualTo<Zero, Zero>     { static const bool value = true;  };
 
-template<uint64_t n, class T>
+template<word n, class T>
 struct GreaterThanOrEqualTo<BigUnsigned<n, T>, Zero> {
     static const bool value = true;
 };
 
-template<uint64_t n, class T>
+template<word n, class T>
 struct GreaterThan<BigUnsigned<n, T>, Zero> {
     static const bool value = n > 0 || GreaterThan<T, Zero>::value;
 };
 
-template<uint64_t a_n, uint64_t b_n, class a_T, class b_T>
+template<word a_n, word b_n, class a_T, class b_T>
 struct GreaterThan<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
     static const bool value =
         GreaterThan<a_T, b_T>::value ? true :
         (GreaterThanOrEqualTo<a_T, b_T>::value && a_n > b_n);
 };
 
-template<uint64_t a_n, uint64_t b_n, class a_T, class b_T>
+template<word a_n, word b_n, class a_T, class b_T>
 struct GreaterThanOrEqualTo<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
     static const bool value =
         GreaterThan<a_T, b_T>::value ? true :
@@ -334,27 +915,27 @@ template<class A, class B> struct Min;
 template<> struct Max<Zero, Zero> { using Result = Zero; };
 template<> struct Min<Zero, Zero> { using Result = Zero; };
 
-template<uint64_t n, class T>
+template<word n, class T>
 struct Max<BigUnsigned<n, T>, Zero> {
     using Result = BigUnsigned<n, T>;
 };
 
-template<uint64_t n, class T>
+template<word n, class T>
 struct Max<Zero, BigUnsigned<n, T>> {
     using Result = BigUnsigned<n, T>;
 };
 
-template<uint64_t n, class T>
+template<word n, class T>
 struct Min<BigUnsigned<n, T>, Zero> {
     using Result = Zero;
 };
 
-template<uint64_t n, class T>
+template<word n, class T>
 struct Min<Zero, BigUnsigned<n, T>> {
     using Result = Zero;
 };
 
-template<uint64_t a_n, uint64_t b_n, class a_T, class b_T>
+template<word a_n, word b_n, class a_T, class b_T>
 struct Max<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
     using A = BigUnsigned<a_n, a_T>;
     using B = BigUnsigned<b_n, b_T>;
@@ -363,7 +944,7 @@ struct Max<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
     >::type;
 };
 
-template<uint64_t a_n, uint64_t b_n, class a_T, class b_T>
+template<word a_n, word b_n, class a_T, class b_T>
 struct Min<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
     using A = BigUnsigned<a_n, a_T>;
     using B = BigUnsigned<b_n, b_T>;
@@ -390,42 +971,141 @@ template<class A>
 struct Division<A, Zero> {
     using Quotient = ErrorType;
     using Residue  = ErrorType;
+    STATIC_BIGNUM_COST();
 };
 
-template<uint64_t n, class T>
+template<word n, class T>
+struct Division<Zero, BigUnsigned<n, T>> {
+    using Quotient = Zero;
+    using Residue  = Zero;
+    STATIC_BIGNUM_COST();
+};
+
+template<word n, class T>
 struct Division<BigUnsigned<n,  T>, One> {
     using Quotient = BigUnsigned<n,  T>;
     using Residue  = Zero;
+    STATIC_BIGNUM_COST();
 };
 
-template<class A, class B>
-struct DummyDivision {
+// digit number i of A, 0 past the most significant one
+template<class A, size_t i> struct Digit { static const word value = 0; };
+template<word n, class T>
+struct Digit<BigUnsigned<n, T>, 0> { static const word value = n; };
+template<word n, class T, size_t i>
+struct Digit<BigUnsigned<n, T>, i> { static const word value = Digit<T, i - 1>::value; };
+
+// A / d for a single nonzero word d, most significant digit first
+template<class A, word d> struct DivisionByWord;
+
+template<word d>
+struct DivisionByWord<Zero, d> {
+    static const word residue = 0;
     using Quotient = Zero;
-    using Residue  = A;
+    using Residue  = Zero;
+    STATIC_BIGNUM_COST();
+};
+
+template<word n, class T, word d>
+struct DivisionByWord<BigUnsigned<n, T>, d> {
+private:
+    using D = DivisionByWord<T, d>;
+public:
+    static const word residue = mod_word(D::residue, n, d);
+    using Quotient = typename Prepend<div_word(D::residue, n, d), typename D::Quotient>::Result;
+    using Residue  = typename Prepend<residue, Zero>::Result;
+    STATIC_BIGNUM_COST(D);
+};
+
+// Knuth's algorithm D. B has at least two digits and its most significant
+// bit set, U < B * P. The estimate q taken from the leading digits is at
+// most 2 too big, the surplus is removed by comparing q * B against U.
+template<class U, class B, word q, class P, bool too_big = GreaterThan<P, U>::value>
+struct QuotientDigitCorrection {
+    static const word value = q;
+    using Residue = typename Difference<U, P>::Result;
+    STATIC_BIGNUM_COST(Difference<U, P>);
+};
+
+template<class U, class B, word q, class P>
+struct QuotientDigitCorrection<U, B, q, P, true>
+    : QuotientDigitCorrection<U, B, q - 1, typename Difference<P, B>::Result> {
+    STATIC_BIGNUM_COST(Difference<P, B>, QuotientDigitCorrection<U, B, q - 1, typename Difference<P, B>::Result>);
+};
+
+template<class U, class B>
+struct QuotientDigit {
+private:
+    static const word u2 = Digit<U, B::length>::value;
+    static const word u1 = Digit<U, B::length - 1>::value;
+    static const word v1 = Digit<B, B::length - 1>::value;
+    static const word estimate = u2 >= v1 ? word_max : div_word(u2, u1, v1);
+    using Correction = QuotientDigitCorrection<
+        U, B, estimate, typename ProductByWord<B, estimate>::Result>;
+public:
+    static const word value = Correction::value;
+    using Residue = typename Correction::Residue;
+    STATIC_BIGNUM_COST(ProductByWord<B, estimate>, Correction);
+};
+
+template<class A, class B> struct LongDivision;
+
+template<class B>
+struct LongDivision<Zero, B> {
+    using Quotient = Zero;
+    using Residue  = Zero;
+    STATIC_BIGNUM_COST();
+};
+
+template<word n, class T, class B>
+struct LongDivision<BigUnsigned<n, T>, B> {
+private:
+    using D = LongDivision<T, B>;
+    using U = typename Prepend<n, typename D::Residue>::Result;
+    using Q = QuotientDigit<U, B>;
+public:
+    using Quotient = typename Prepend<Q::value, typename D::Quotient>::Result;
+    using Residue  = typename Q::Residue;
+    STATIC_BIGNUM_COST(D, Q);
+};
+
+template<class A, class B>
+struct NormalizedDivision {
+private:
+    static const size_t shift = leading_zeros(Digit<B, B::length - 1>::value);
+    using U = SmallShiftLeft<A, shift>;
+    using V = SmallShiftLeft<B, shift>;
+    using D = LongDivision<typename U::Result, typename V::Result>;
+    using R = SmallShiftRight<typename D::Residue, shift>;
+public:
+    using Quotient = typename D::Quotient;
+    using Residue  = typename R::Result;
+    STATIC_BIGNUM_COST(U, V, D, R);
 };
 
-template<uint64_t a_n, uint64_t b_n, class a_T, class b_T>
+template<word a_n, word b_n, class a_T, class b_T>
 struct Division<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
 private:
     using A = BigUnsigned<a_n, a_T>;
     using B = BigUnsigned<b_n, b_T>;
+#ifdef STATIC_BIGNUM_CONSTEXPR_BACKEND
+    using D = ConstexprDivision<A, B>;
+public:
+    STATIC_BIGNUM_COST();
+#else
     using D = typename std::conditional<
-        GreaterThanOrEqualTo<A, B>::value,
-        Division<A, typename SmallShiftLeft<B, 1>::Result>,
-        DummyDivision<A, B>
+        std::is_same<b_T, Zero>::value,
+        DivisionByWord<A, b_n>,
+        NormalizedDivision<A, B>
     >::type;
-    using Q = typename D::Quotient;
-    using R = typename D::Residue;
 public:
-    using Quotient = typename Sum<
-        typename SmallShiftLeft<Q, 1>::Result,
-        typename std::conditional<GreaterThanOrEqualTo<R, B>::value, One, Zero>::type
-    >::Result;
-    using Residue = typename std::conditional<
-        GreaterThanOrEqualTo<R, B>::value,
-        typename Difference<R, B>::Result,
-        R
-    >::type;
+    STATIC_BIGNUM_COST(D);
+#endif
+    using Quotient = typename D::Quotient;
+    using Residue  = typename D::Residue;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Quotient, "Division");
+    STATIC_BIGNUM_ASSERT_CANONICAL(Residue, "Division");
+    STATIC_BIGNUM_ASSERT_BUDGET(Division, "Division");
 };
 
 #ifdef STATIC_BIGNUM_USE_MACRO
@@ -434,59 +1114,742 @@ public:
 #endif
 
 ///////////////////////////////////////////////////////////////////////////
-//////////////////////////// signed operations ////////////////////////////
+//////////////////////////// fused operations /////////////////////////////
 ///////////////////////////////////////////////////////////////////////////
 
-template<int s, class T>
-struct BigSigned {
-    static_assert(s == 1 || s == -1, "only 1 or -1 are allowed as signs");
-    static const int sign = s;
-    using Abs = T;
-    static inline std::string bin(void) {
-        return (s < 0 ? "-" : "") + T::bin();
-    }
-    static inline std::string dec(void) {
-        return (s < 0 ? "-" : "") + T::dec();
-    }
-    static inline void write_to(uint64_t* dest) {
-        T::write_to(dest);
-    }
+// Expressions over unsigned numbers built from Times, Plus and Modulo nodes
+// are evaluated by Evaluate without materializing every intermediate
+// result: products are accumulated straight into the sum they are part of
+// through MulAdd, so a * b + c * d + e takes two MulAdd passes and no
+// separate shifts or sums, while Modulo divides the accumulated result once.
+
+// A * B mod M, the product accumulated by MulAdd
+template<class A, class B, class M>
+struct MulMod {
+    using Result = typename Division<typename MulAdd<A, B, Zero>::Result, M>::Residue;
+    STATIC_BIGNUM_COST(MulAdd<A, B, Zero>, Division<typename MulAdd<A, B, Zero>::Result, M>);
 };
 
-#define BIGSIGNED_1(x1)             static_bignum::BigSigned<1, BIGUNSIGNED_1(x1)>
-#define BIGSIGNED_2(x1, x2)         static_bignum::BigSigned<1, BIGUNSIGNED_2((x1), (x2))>
-#define BIGSIGNED_3(x1, x2, x3)     static_bignum::BigSigned<1, BIGUNSIGNED_3((x1), (x2), (x3))>
-#define BIGSIGNED_4(x1, x2, x3, x4) static_bignum::BigSigned<1, BIGUNSIGNED_4((x1), (x2), (x3), (x4))>
+template<class... ab> struct SumOfProducts;
 
+template<>
+struct SumOfProducts<> { using Result = Zero; STATIC_BIGNUM_COST(); };
 
-template<class A> struct Minus;
-template<int s, class T>
-struct Minus<BigSigned<s, T>> {
-    using Result = BigSigned<-s, T>;
-};
-template<uint64_t n, class T>
-struct Minus<BigUnsigned<n, T>> {
-    using Result = BigSigned<-1, BigUnsigned<n, T>>;
+// A1 * B1 + A2 * B2 + ...
+template<class A, class B, class... ab>
+struct SumOfProducts<A, B, ab...>
+    : MulAdd<A, B, typename SumOfProducts<ab...>::Result> {
+    STATIC_BIGNUM_COST(SumOfProducts<ab...>, MulAdd<A, B, typename SumOfProducts<ab...>::Result>);
 };
 
-#ifdef STATIC_BIGNUM_USE_MACRO
-#define SBN_MINUS(x) static_bignum::Minus<x>::Result
-#endif
+template<class A, class B> struct Times {};
+template<class A, class B> struct Plus {};
+template<class A, class M> struct Modulo {};
 
-template<class A> struct Signed;
-template<uint64_t n, class T>
-struct Signed<BigUnsigned<n, T>> {
-    using Result = BigSigned<1, BigUnsigned<n, T>>;
-};
+template<class E> struct Evaluate { using Result = E; };
 
-using PositiveZero = BigSigned< 1, Zero>;
-using NegativeZero = BigSigned<-1, Zero>;
-using SignedOne = typename Signed<One>::Result;
+// E + C
+template<class E, class C>
+struct Accumulate : Sum<typename Evaluate<E>::Result, C> {};
 
-template<int s, class a_T, class b_T>
-struct Sum<BigSigned<s, a_T>, BigSigned<s, b_T>> {
-    using Result = BigSigned<s, typename Sum<a_T, b_T>::Result>;
-};
+template<class A, class B, class C>
+struct Accumulate<Times<A, B>, C>
+    : MulAdd<typename Evaluate<A>::Result, typename Evaluate<B>::Result, C> {};
+
+template<class A, class B, class C>
+struct Accumulate<Plus<A, B>, C>
+    : Accumulate<A, typename Accumulate<B, C>::Result> {};
+
+template<class A, class B>
+struct Evaluate<Times<A, B>> : Accumulate<Times<A, B>, Zero> {};
+
+template<class A, class B>
+struct Evaluate<Plus<A, B>> : Accumulate<Plus<A, B>, Zero> {};
+
+template<class E, class M>
+struct Evaluate<Modulo<E, M>> {
+    using Result = typename Division<
+        typename Evaluate<E>::Result, typename Evaluate<M>::Result
+    >::Residue;
+};
+
+#ifdef STATIC_BIGNUM_USE_MACRO
+#define SBN_MULADD(x, y, z) static_bignum::MulAdd<x, y, z>::Result
+#define SBN_MULMOD(x, y, m) static_bignum::MulMod<x, y, m>::Result
+#define SBN_EVAL(e)         static_bignum::Evaluate<e>::Result
+#endif
+
+///////////////////////////////////////////////////////////////////////////
+/////////////////////////// flat representation ///////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// FlatUnsigned keeps all digits of a number in a single pack, least
+// significant first and without leading zero words, so its length and
+// digits are available without recursion. Sums, differences, shifts and
+// comparisons compute every digit of the result from the operands' word
+// arrays through an index sequence instead of instantiating a template per
+// word; products and quotients go through BigUnsigned.
+
+template<word... digits>
+struct FlatUnsigned {
+    using word = static_bignum::word;
+    static const size_t length = sizeof...(digits);
+    // padded with a zero word, so that FlatUnsigned<> has an array too
+    alignas(64) static constexpr word words[] = {digits..., 0};
+    static inline std::string bin(void) {
+        return BinaryRepresentation<FlatUnsigned>::str();
+    }
+    static inline std::string dec(void) {
+        return DecimalRepresentation<FlatUnsigned>::str();
+    }
+    static inline std::string hex(void) {
+        return HexRepresentation<FlatUnsigned>::str();
+    }
+    static constexpr const char* bin_c_str(void) {
+        return BinaryRepresentation<FlatUnsigned>::c_str();
+    }
+    static constexpr const char* dec_c_str(void) {
+        return DecimalRepresentation<FlatUnsigned>::c_str();
+    }
+    static constexpr const char* hex_c_str(void) {
+        return HexRepresentation<FlatUnsigned>::c_str();
+    }
+#if __cplusplus >= 201703L
+    static constexpr std::string_view bin_view(void) {
+        return BinaryRepresentation<FlatUnsigned>::view();
+    }
+    static constexpr std::string_view dec_view(void) {
+        return DecimalRepresentation<FlatUnsigned>::view();
+    }
+    static constexpr std::string_view hex_view(void) {
+        return HexRepresentation<FlatUnsigned>::view();
+    }
+#endif
+    static constexpr const word* data(void) {
+        return words;
+    }
+    // rounded to nearest, ties to even
+    static constexpr double to_double(void) {
+        return FloatingValue<FlatUnsigned, double>::value;
+    }
+    static constexpr long double to_long_double(void) {
+        return FloatingValue<FlatUnsigned, long double>::value;
+    }
+    static inline void write_to(word* dest) {
+        std::memcpy(dest, words, length * sizeof(word));
+    }
+    // the digits cut into length_in<Limb>() limbs of another width
+    template<class Limb>
+    static inline void write_to(Limb* dest) {
+        std::memcpy(dest, LimbArray<FlatUnsigned, Limb>::value, length_in<Limb>() * sizeof(Limb));
+    }
+    template<class Limb>
+    static constexpr size_t length_in(void) {
+        return (length * word_bits + 8 * sizeof(Limb) - 1) / (8 * sizeof(Limb));
+    }
+    static inline void to_bytes_le(uint8_t* dest) {
+        std::memcpy(dest, ByteArray<FlatUnsigned, false>::value, length * sizeof(word));
+    }
+    static inline void to_bytes_be(uint8_t* dest) {
+        std::memcpy(dest, ByteArray<FlatUnsigned, true>::value, length * sizeof(word));
+    }
+    static constexpr word get_digit(size_t which) {
+        return which < length ? words[which] : 0;
+    }
+};
+
+template<word... digits>
+alignas(64) constexpr word FlatUnsigned<digits...>::words[];
+
+template<class A, word... digits> struct FlattenDigits;
+
+template<word... digits>
+struct FlattenDigits<Zero, digits...> { using Result = FlatUnsigned<digits...>; };
+
+template<word n, class T, word... digits>
+struct FlattenDigits<BigUnsigned<n, T>, digits...> : FlattenDigits<T, digits..., n> {};
+
+// BigUnsigned -> FlatUnsigned and back
+template<class A>
+struct Flatten { using Result = typename FlattenDigits<typename Optimize<A>::Result>::Result; };
+template<word... digits>
+struct Flatten<FlatUnsigned<digits...>> { using Result = FlatUnsigned<digits...>; };
+template<>
+struct Flatten<ErrorType> { using Result = ErrorType; };
+
+template<class A>
+struct Unflatten { using Result = A; };
+template<word... digits>
+struct Unflatten<FlatUnsigned<digits...>> { using Result = typename PackWords<digits...>::Result; };
+
+template<word... digits>
+struct DecimalRepresentation<FlatUnsigned<digits...>>
+    : DecimalRepresentation<typename Unflatten<FlatUnsigned<digits...>>::Result> {};
+template<word... digits>
+struct HexRepresentation<FlatUnsigned<digits...>>
+    : HexRepresentation<typename Unflatten<FlatUnsigned<digits...>>::Result> {};
+template<word... digits>
+struct BinaryRepresentation<FlatUnsigned<digits...>>
+    : BinaryRepresentation<typename Unflatten<FlatUnsigned<digits...>>::Result> {};
+
+constexpr size_t significant_length(const word* digits, size_t n) {
+    return n > 0 && digits[n - 1] == 0 ? significant_length(digits, n - 1) : n;
+}
+
+// H::value[0 .. H::size) without leading zero words
+template<class H, class I = typename MakeIndexSequence<significant_length(H::value, H::size)>::Result>
+struct Trim;
+
+template<class H, size_t... i>
+struct Trim<H, IndexSequence<i...>> { using Result = FlatUnsigned<H::value[i]...>; };
+
+template<word... digits>
+struct IsCanonical<FlatUnsigned<digits...>> {
+    static const bool value = significant_length(
+        FlatUnsigned<digits...>::words, sizeof...(digits)) == sizeof...(digits);
+};
+
+constexpr word add_carry(word a, word b, word carry) {
+    return (a + carry < carry || a + carry + b < b) ? 1 : 0;
+}
+
+constexpr word subtract_borrow(word a, word b, word borrow) {
+    return (a < b || a - b < borrow) ? 1 : 0;
+}
+
+// carry into digit i of A + B
+template<class A, class B>
+constexpr word sum_carry(size_t i) {
+    return i == 0 ? 0 : add_carry(A::get_digit(i - 1), B::get_digit(i - 1), sum_carry<A, B>(i - 1));
+}
+
+// borrow into digit i of A - B
+template<class A, class B>
+constexpr word difference_borrow(size_t i) {
+    return i == 0 ? 0 : subtract_borrow(A::get_digit(i - 1), B::get_digit(i - 1), difference_borrow<A, B>(i - 1));
+}
+
+template<class A>
+constexpr word shift_left_digit(size_t i, size_t shift) {
+    return (i >= shift / word_bits ? A::get_digit(i - shift / word_bits) << shift % word_bits : 0)
+         | (shift % word_bits != 0 && i > shift / word_bits
+            ? A::get_digit(i - shift / word_bits - 1) >> (word_bits - shift % word_bits) : 0);
+}
+
+template<class A>
+constexpr word shift_right_digit(size_t i, size_t shift) {
+    return (A::get_digit(i + shift / word_bits) >> shift % word_bits)
+         | (shift % word_bits != 0 ? A::get_digit(i + shift / word_bits + 1) << (word_bits - shift % word_bits) : 0);
+}
+
+// sign of A - B, comparing the lowest i digits
+template<class A, class B>
+constexpr int flat_compare(size_t i) {
+    return i == 0 ? 0
+         : A::get_digit(i - 1) != B::get_digit(i - 1) ? (A::get_digit(i - 1) > B::get_digit(i - 1) ? 1 : -1)
+         : flat_compare<A, B>(i - 1);
+}
+
+template<class A, class B, class I = typename MakeIndexSequence<
+    (A::length > B::length ? A::length : B::length) + 1>::Result>
+struct FlatSumDigits;
+
+template<class A, class B, size_t... i>
+struct FlatSumDigits<A, B, IndexSequence<i...>> {
+    static const size_t size = sizeof...(i);
+    static constexpr word value[] = {
+        (A::get_digit(i) + B::get_digit(i) + sum_carry<A, B>(i))..., 0};
+};
+
+template<class A, class B, size_t... i>
+constexpr word FlatSumDigits<A, B, IndexSequence<i...>>::value[];
+
+template<class A, class B, class I = typename MakeIndexSequence<
+    (A::length > B::length ? A::length : B::length)>::Result>
+struct FlatDifferenceDigits;
+
+template<class A, class B, size_t... i>
+struct FlatDifferenceDigits<A, B, IndexSequence<i...>> {
+    static const size_t size = sizeof...(i);
+    static const bool negative = difference_borrow<A, B>(size) != 0;
+    static constexpr word value[] = {
+        (A::get_digit(i) - B::get_digit(i) - difference_borrow<A, B>(i))..., 0};
+};
+
+template<class A, class B, size_t... i>
+constexpr word FlatDifferenceDigits<A, B, IndexSequence<i...>>::value[];
+
+template<class A, size_t shift, class I = typename MakeIndexSequence<
+    A::length == 0 ? 0 : A::length + shift / word_bits + 1>::Result>
+struct FlatShiftLeftDigits;
+
+template<class A, size_t shift, size_t... i>
+struct FlatShiftLeftDigits<A, shift, IndexSequence<i...>> {
+    static const size_t size = sizeof...(i);
+    static constexpr word value[] = {shift_left_digit<A>(i, shift)..., 0};
+};
+
+template<class A, size_t shift, size_t... i>
+constexpr word FlatShiftLeftDigits<A, shift, IndexSequence<i...>>::value[];
+
+template<class A, size_t shift, class I = typename MakeIndexSequence<
+    (A::length > shift / word_bits ? A::length - shift / word_bits : 0)>::Result>
+struct FlatShiftRightDigits;
+
+template<class A, size_t shift, size_t... i>
+struct FlatShiftRightDigits<A, shift, IndexSequence<i...>> {
+    static const size_t size = sizeof...(i);
+    static constexpr word value[] = {shift_right_digit<A>(i, shift)..., 0};
+};
+
+template<class A, size_t shift, size_t... i>
+constexpr word FlatShiftRightDigits<A, shift, IndexSequence<i...>>::value[];
+
+template<word... a, word... b>
+struct Sum<FlatUnsigned<a...>, FlatUnsigned<b...>> {
+    using Result = typename Trim<FlatSumDigits<FlatUnsigned<a...>, FlatUnsigned<b...>>>::Result;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "Sum");
+    STATIC_BIGNUM_COST();
+};
+
+template<word... a, word... b>
+struct Difference<FlatUnsigned<a...>, FlatUnsigned<b...>> {
+private:
+    using D = FlatDifferenceDigits<FlatUnsigned<a...>, FlatUnsigned<b...>>;
+public:
+    using Result = typename std::conditional<
+        D::negative, ErrorType, typename Trim<D>::Result
+    >::type;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "Difference");
+    STATIC_BIGNUM_COST();
+};
+
+template<word... digits, size_t shift>
+struct ShiftLeft<FlatUnsigned<digits...>, shift> {
+    using Result = typename Trim<FlatShiftLeftDigits<FlatUnsigned<digits...>, shift>>::Result;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "ShiftLeft");
+    STATIC_BIGNUM_COST();
+};
+
+template<word... digits, size_t shift>
+struct ShiftRight<FlatUnsigned<digits...>, shift> {
+    using Result = typename Trim<FlatShiftRightDigits<FlatUnsigned<digits...>, shift>>::Result;
+    STATIC_BIGNUM_ASSERT_CANONICAL(Result, "ShiftRight");
+    STATIC_BIGNUM_COST();
+};
+
+template<word... a, word... b>
+struct GreaterThan<FlatUnsigned<a...>, FlatUnsigned<b...>> {
+    static const bool value = flat_compare<FlatUnsigned<a...>, FlatUnsigned<b...>>(
+        sizeof...(a) > sizeof...(b) ? sizeof...(a) : sizeof...(b)) > 0;
+};
+
+template<word... a, word... b>
+struct GreaterThanOrEqualTo<FlatUnsigned<a...>, FlatUnsigned<b...>> {
+    static const bool value = flat_compare<FlatUnsigned<a...>, FlatUnsigned<b...>>(
+        sizeof...(a) > sizeof...(b) ? sizeof...(a) : sizeof...(b)) >= 0;
+};
+
+template<word... a, word... b>
+struct Product<FlatUnsigned<a...>, FlatUnsigned<b...>> {
+private:
+    using P = Product<
+        typename Unflatten<FlatUnsigned<a...>>::Result,
+        typename Unflatten<FlatUnsigned<b...>>::Result
+    >;
+public:
+    using Result = typename Flatten<typename P::Result>::Result;
+    STATIC_BIGNUM_COST(P);
+};
+
+template<word... a, word... b>
+struct Division<FlatUnsigned<a...>, FlatUnsigned<b...>> {
+private:
+    using D = Division<
+        typename Unflatten<FlatUnsigned<a...>>::Result,
+        typename Unflatten<FlatUnsigned<b...>>::Result
+    >;
+public:
+    using Quotient = typename Flatten<typename D::Quotient>::Result;
+    using Residue  = typename Flatten<typename D::Residue>::Result;
+    STATIC_BIGNUM_COST(D);
+};
+
+///////////////////////////////////////////////////////////////////////////
+//////////////////////////// constexpr backend ////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// With STATIC_BIGNUM_CONSTEXPR_BACKEND defined (C++14 and later), unsigned
+// Sum, Difference, Product, Division and shifts unpack their arguments into
+// fixed-size word arrays, compute with constexpr functions and pack the
+// result back into a BigUnsigned. The compiler then evaluates loops instead
+// of instantiating one template per word or bit.
+
+#ifdef STATIC_BIGNUM_CONSTEXPR_BACKEND
+
+template<size_t N>
+struct Words {
+    word digits[N];
+};
+
+template<size_t N>
+constexpr size_t words_length(const Words<N>& a) {
+    size_t n = N;
+    while (n > 0 && a.digits[n - 1] == 0) --n;
+    return n;
+}
+
+template<size_t N>
+constexpr bool words_less(const Words<N>& a, const Words<N>& b) {
+    for (size_t i = N; i-- > 0;)
+        if (a.digits[i] != b.digits[i])
+            return a.digits[i] < b.digits[i];
+    return false;
+}
+
+template<size_t N>
+constexpr Words<N> words_add(const Words<N>& a, const Words<N>& b) {
+    Words<N> result{};
+    word carry = 0;
+    for (size_t i = 0; i < N; ++i) {
+        const word s = a.digits[i] + carry;
+        carry = s < carry ? 1 : 0;
+        result.digits[i] = s + b.digits[i];
+        carry += result.digits[i] < s ? 1 : 0;
+    }
+    return result;
+}
+
+// a - b modulo P ** N
+template<size_t N>
+constexpr Words<N> words_subtract(const Words<N>& a, const Words<N>& b) {
+    Words<N> result{};
+    word borrow = 0;
+    for (size_t i = 0; i < N; ++i) {
+        const word d = a.digits[i] - b.digits[i];
+        const word next = (a.digits[i] < b.digits[i] || d < borrow) ? 1 : 0;
+        result.digits[i] = d - borrow;
+        borrow = next;
+    }
+    return result;
+}
+
+// a * b modulo P ** N
+template<size_t N>
+constexpr Words<N> words_multiply(const Words<N>& a, const Words<N>& b) {
+    Words<N> result{};
+    for (size_t j = 0; j < N; ++j) {
+        if (b.digits[j] == 0) continue;
+        word carry = 0;
+        for (size_t i = 0; i + j < N; ++i) {
+            word low  = mul_lo(a.digits[i], b.digits[j]) + carry;
+            word high = mul_hi(a.digits[i], b.digits[j]) + (low < carry ? 1 : 0);
+            result.digits[i + j] += low;
+            high += result.digits[i + j] < low ? 1 : 0;
+            carry = high;
+        }
+    }
+    return result;
+}
+
+template<size_t N>
+constexpr Words<N> words_shift_left(const Words<N>& a, size_t shift) {
+    Words<N> result{};
+    const size_t big = shift / word_bits, small = shift % word_bits;
+    for (size_t i = N; i-- > big;) {
+        result.digits[i] = a.digits[i - big] << small;
+        if (small != 0 && i > big)
+            result.digits[i] |= a.digits[i - big - 1] >> (word_bits - small);
+    }
+    return result;
+}
+
+template<size_t N>
+constexpr Words<N> words_shift_right(const Words<N>& a, size_t shift) {
+    Words<N> result{};
+    const size_t big = shift / word_bits, small = shift % word_bits;
+    for (size_t i = 0; i + big < N; ++i) {
+        result.digits[i] = a.digits[i + big] >> small;
+        if (small != 0 && i + big + 1 < N)
+            result.digits[i] |= a.digits[i + big + 1] << (word_bits - small);
+    }
+    return result;
+}
+
+template<size_t N>
+struct WordsDivision {
+    Words<N> quotient;
+    Words<N> residue;
+};
+
+// Knuth's algorithm D, b must not be zero
+template<size_t N>
+constexpr WordsDivision<N> words_divide(const Words<N>& a, const Words<N>& b) {
+    WordsDivision<N> result{};
+    const size_t n = words_length(b);
+    if (n == 1) {
+        word r = 0;
+        for (size_t i = N; i-- > 0;) {
+            result.quotient.digits[i] = div_word(r, a.digits[i], b.digits[0]);
+            r = mod_word(r, a.digits[i], b.digits[0]);
+        }
+        result.residue.digits[0] = r;
+        return result;
+    }
+    const int shift = leading_zeros(b.digits[n - 1]);
+    const Words<N> v = words_shift_left(b, shift);
+    Words<N + 1> u{};
+    for (size_t i = 0; i < N; ++i) {
+        u.digits[i] |= a.digits[i] << shift;
+        if (shift != 0)
+            u.digits[i + 1] = a.digits[i] >> (word_bits - shift);
+    }
+    for (size_t j = N - n + 1; j-- > 0;) {
+        word q = u.digits[j + n] >= v.digits[n - 1] ? word_max
+                   : div_word(u.digits[j + n], u.digits[j + n - 1], v.digits[n - 1]);
+        // u[j .. j + n] -= q * v
+        word carry = 0, borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const word low  = mul_lo(q, v.digits[i]) + carry;
+            carry = mul_hi(q, v.digits[i]) + (low < carry ? 1 : 0);
+            const word d = u.digits[i + j] - low;
+            const word next = (u.digits[i + j] < low || d < borrow) ? 1 : 0;
+            u.digits[i + j] = d - borrow;
+            borrow = next;
+        }
+        const word top = u.digits[j + n];
+        bool negative = top < carry || top - carry < borrow;
+        u.digits[j + n] = top - carry - borrow;
+        // q was at most 2 too big, add v back until u[j .. j + n] wraps around
+        while (negative) {
+            --q;
+            word c = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const word s = u.digits[i + j] + c;
+                c = s < c ? 1 : 0;
+                u.digits[i + j] = s + v.digits[i];
+                c += u.digits[i + j] < s ? 1 : 0;
+            }
+            u.digits[j + n] += c;
+            negative = !(c != 0 && u.digits[j + n] == 0);
+        }
+        result.quotient.digits[j] = q;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        result.residue.digits[i] = u.digits[i] >> shift;
+        if (shift != 0)
+            result.residue.digits[i] |= u.digits[i + 1] << (word_bits - shift);
+    }
+    return result;
+}
+
+// BigUnsigned -> Words<N>, least significant digit first
+template<size_t N, class A, word... digits> struct UnpackWords;
+
+template<size_t N, word... digits>
+struct UnpackWords<N, Zero, digits...> {
+    static constexpr Words<N> value{{digits...}};
+};
+
+template<size_t N, word... digits>
+constexpr Words<N> UnpackWords<N, Zero, digits...>::value;
+
+template<size_t N, word n, class T, word... digits>
+struct UnpackWords<N, BigUnsigned<n, T>, digits...> : UnpackWords<N, T, digits..., n> {};
+
+// H::value -> optimized BigUnsigned
+template<class H, class I = std::make_index_sequence<H::size>> struct FromWords;
+
+template<class H, size_t... i>
+struct FromWords<H, std::index_sequence<i...>> {
+    using Result = typename PackWords<H::value.digits[i]...>::Result;
+};
+
+template<class A, class B>
+struct ConstexprSum {
+    static constexpr size_t size = (A::length > B::length ? A::length : B::length) + 1;
+    static constexpr Words<size> value = words_add(
+        UnpackWords<size, A>::value, UnpackWords<size, B>::value);
+    using Result = typename FromWords<ConstexprSum>::Result;
+};
+
+template<class A, class B>
+constexpr Words<ConstexprSum<A, B>::size> ConstexprSum<A, B>::value;
+
+template<class A, class B>
+struct ConstexprDifference {
+    static constexpr size_t size = A::length > B::length ? A::length : B::length;
+    static constexpr bool negative = words_less(
+        UnpackWords<size, A>::value, UnpackWords<size, B>::value);
+    static constexpr Words<size> value = words_subtract(
+        UnpackWords<size, A>::value, UnpackWords<size, B>::value);
+    using Result = typename std::conditional<
+        negative, ErrorType, typename FromWords<ConstexprDifference>::Result
+    >::type;
+};
+
+template<class A, class B>
+constexpr Words<ConstexprDifference<A, B>::size> ConstexprDifference<A, B>::value;
+
+template<class A, class B>
+struct ConstexprProduct {
+    static constexpr size_t size = A::length + B::length;
+    static constexpr Words<size> value = words_multiply(
+        UnpackWords<size, A>::value, UnpackWords<size, B>::value);
+    using Result = typename FromWords<ConstexprProduct>::Result;
+};
+
+template<class A, class B>
+constexpr Words<ConstexprProduct<A, B>::size> ConstexprProduct<A, B>::value;
+
+template<class A, class B>
+struct ConstexprDivision {
+private:
+    static constexpr size_t size = A::length > B::length ? A::length : B::length;
+    static constexpr WordsDivision<size> division = words_divide(
+        UnpackWords<size, A>::value, UnpackWords<size, B>::value);
+    struct Q {
+        static constexpr size_t size = ConstexprDivision::size;
+        static constexpr Words<size> value = division.quotient;
+    };
+    struct R {
+        static constexpr size_t size = ConstexprDivision::size;
+        static constexpr Words<size> value = division.residue;
+    };
+public:
+    using Quotient = typename FromWords<Q>::Result;
+    using Residue  = typename FromWords<R>::Result;
+};
+
+template<class A, class B>
+constexpr WordsDivision<ConstexprDivision<A, B>::size> ConstexprDivision<A, B>::division;
+
+template<class A, size_t shift>
+struct ConstexprShiftLeft {
+    static constexpr size_t size = A::length + shift / word_bits + 1;
+    static constexpr Words<size> value = words_shift_left(UnpackWords<size, A>::value, shift);
+    using Result = typename FromWords<ConstexprShiftLeft>::Result;
+};
+
+template<class A, size_t shift>
+constexpr Words<ConstexprShiftLeft<A, shift>::size> ConstexprShiftLeft<A, shift>::value;
+
+template<class A, size_t shift>
+struct ConstexprShiftRight {
+    static constexpr size_t size = A::length;
+    static constexpr Words<size> value = words_shift_right(UnpackWords<size, A>::value, shift);
+    using Result = typename FromWords<ConstexprShiftRight>::Result;
+};
+
+template<class A, size_t shift>
+constexpr Words<ConstexprShiftRight<A, shift>::size> ConstexprShiftRight<A, shift>::value;
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////
+//////////////////////////// signed operations ////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+template<int s, class T>
+struct BigSigned {
+    static_assert(s == 1 || s == -1, "only 1 or -1 are allowed as signs");
+    static const int sign = s;
+    using Abs = T;
+    static inline std::string bin(void) {
+        return BinaryRepresentation<BigSigned>::str();
+    }
+    static inline std::string dec(void) {
+        return DecimalRepresentation<BigSigned>::str();
+    }
+    static inline std::string hex(void) {
+        return HexRepresentation<BigSigned>::str();
+    }
+    static constexpr const char* bin_c_str(void) {
+        return BinaryRepresentation<BigSigned>::c_str();
+    }
+    static constexpr const char* dec_c_str(void) {
+        return DecimalRepresentation<BigSigned>::c_str();
+    }
+    static constexpr const char* hex_c_str(void) {
+        return HexRepresentation<BigSigned>::c_str();
+    }
+#if __cplusplus >= 201703L
+    static constexpr std::string_view bin_view(void) {
+        return BinaryRepresentation<BigSigned>::view();
+    }
+    static constexpr std::string_view dec_view(void) {
+        return DecimalRepresentation<BigSigned>::view();
+    }
+    static constexpr std::string_view hex_view(void) {
+        return HexRepresentation<BigSigned>::view();
+    }
+#endif
+    static constexpr const word* data(void) {
+        return T::data();
+    }
+    // rounded to nearest, ties to even
+    static constexpr double to_double(void) {
+        return FloatingValue<BigSigned, double>::value;
+    }
+    static constexpr long double to_long_double(void) {
+        return FloatingValue<BigSigned, long double>::value;
+    }
+    static inline void write_to(word* dest) {
+        T::write_to(dest);
+    }
+    template<class Limb>
+    static inline void write_to(Limb* dest) {
+        T::write_to(dest);
+    }
+    template<class Limb>
+    static constexpr size_t length_in(void) {
+        return T::template length_in<Limb>();
+    }
+    static inline void to_bytes_le(uint8_t* dest) {
+        T::to_bytes_le(dest);
+    }
+    static inline void to_bytes_be(uint8_t* dest) {
+        T::to_bytes_be(dest);
+    }
+};
+
+template<int s, class T> struct IsCanonical<BigSigned<s, T>> : IsCanonical<T> {};
+
+#define BIGSIGNED_1(x1)             static_bignum::BigSigned<1, BIGUNSIGNED_1(x1)>
+#define BIGSIGNED_2(x1, x2)         static_bignum::BigSigned<1, BIGUNSIGNED_2((x1), (x2))>
+#define BIGSIGNED_3(x1, x2, x3)     static_bignum::BigSigned<1, BIGUNSIGNED_3((x1), (x2), (x3))>
+#define BIGSIGNED_4(x1, x2, x3, x4) static_bignum::BigSigned<1, BIGUNSIGNED_4((x1), (x2), (x3), (x4))>
+
+
+template<class A> struct Minus;
+template<int s, class T>
+struct Minus<BigSigned<s, T>> {
+    using Result = BigSigned<-s, T>;
+};
+template<word n, class T>
+struct Minus<BigUnsigned<n, T>> {
+    using Result = BigSigned<-1, BigUnsigned<n, T>>;
+};
+
+#ifdef STATIC_BIGNUM_USE_MACRO
+#define SBN_MINUS(x) static_bignum::Minus<x>::Result
+#endif
+
+template<class A> struct Signed;
+template<word n, class T>
+struct Signed<BigUnsigned<n, T>> {
+    using Result = BigSigned<1, BigUnsigned<n, T>>;
+};
+
+using PositiveZero = BigSigned< 1, Zero>;
+using NegativeZero = BigSigned<-1, Zero>;
+using SignedOne = typename Signed<One>::Result;
+
+template<int s, class a_T, class b_T>
+struct Sum<BigSigned<s, a_T>, BigSigned<s, b_T>> {
+    using Result = BigSigned<s, typename Sum<a_T, b_T>::Result>;
+    STATIC_BIGNUM_COST(Sum<a_T, b_T>);
+};
 
 template<int s, class a_T, class b_T>
 struct Sum<BigSigned<s, a_T>, BigSigned<-s, b_T>> {
@@ -498,26 +1861,31 @@ struct Sum<BigSigned<s, a_T>, BigSigned<-s, b_T>> {
             typename Difference<b_T, a_T>::Result
         >::type
     >;
+    STATIC_BIGNUM_COST(Difference<a_T, b_T>, Difference<b_T, a_T>);
 };
 
 template<int a_s, int b_s, class a_T, class b_T>
 struct Difference<BigSigned<a_s, a_T>, BigSigned<b_s, b_T>> {
     using Result = typename Sum<BigSigned<a_s, a_T>, BigSigned<-b_s, b_T>>::Result;
+    STATIC_BIGNUM_COST(Sum<BigSigned<a_s, a_T>, BigSigned<-b_s, b_T>>);
 };
 
 template<int s, class T, size_t shift>
 struct ShiftLeft<BigSigned<s, T>, shift> {
     using Result = BigSigned<s, typename ShiftLeft<T, shift>::Result>;
+    STATIC_BIGNUM_COST(ShiftLeft<T, shift>);
 };
 
 template<int s, class T, size_t shift>
 struct ShiftRight<BigSigned<s, T>, shift> {
     using Result = BigSigned<s, typename ShiftRight<T, shift>::Result>;
+    STATIC_BIGNUM_COST(ShiftRight<T, shift>);
 };
 
 template<int a_s, int b_s, class a_T, class b_T>
 struct Product<BigSigned<a_s, a_T>, BigSigned<b_s, b_T>> {
     using Result = BigSigned<a_s * b_s, typename Product<a_T, b_T>::Result>;
+    STATIC_BIGNUM_COST(Product<a_T, b_T>);
 };
 
 template<int a_s, int b_s, class a_T, class b_T>
@@ -567,51 +1935,366 @@ private:
 public:
     using Quotient = BigSigned<a_s * b_s, Q>;
     using Residue  = BigSigned<a_s, R>;
+    STATIC_BIGNUM_COST(D);
 };
 
 // TODO mixed definitions, e. g. signed + unsigned
 
 ///////////////////////////////////////////////////////////////////////////
-///////////////////////// decimal representation //////////////////////////
+////////////////////////// string representation //////////////////////////
 ///////////////////////////////////////////////////////////////////////////
 
-template<class A> struct DecimalRepresentation;
+// Decimal, hexadecimal and binary strings are generated at compile time into
+// NUL-terminated static constexpr char arrays, so printing a number is just
+// a pointer load. Hexadecimal and binary strings have word_bits / 4 and
+// word_bits characters per word respectively, including leading zeros.
 
-template<>
-struct DecimalRepresentation<Zero> {
+// G::at(0), ..., G::at(G::size - 1) and a trailing NUL
+template<class G, class I = typename MakeIndexSequence<G::size>::Result> struct StaticString;
+
+template<class G, size_t... i>
+struct StaticString<G, IndexSequence<i...>> {
+    static constexpr char value[] = {G::at(i)..., '\0'};
+};
+
+template<class G, size_t... i>
+constexpr char StaticString<G, IndexSequence<i...>>::value[];
+
+template<class G>
+struct Representation {
+    static const size_t size = G::size;
+    static constexpr const char* c_str(void) {
+        return StaticString<G>::value;
+    }
     static inline std::string str(void) {
-        return "0";
+        return std::string(c_str(), size);
     }
+#if __cplusplus >= 201703L
+    static constexpr std::string_view view(void) {
+        return std::string_view(c_str(), size);
+    }
+#endif
 };
 
-template<uint64_t n>
-struct DecimalRepresentation<BigUnsigned<n, Zero>> {
-    static inline std::string str(void) {
-        return std::to_string(n);
+constexpr char hex_char(word x) {
+    return static_cast<char>(x < 10 ? '0' + x : 'a' + (x - 10));
+}
+
+template<class A>
+struct BinaryDigits {
+    static const size_t size = word_bits * A::length;
+    static constexpr char at(size_t i) {
+        return hex_char(WordArray<A>::value[A::length - 1 - i / word_bits] >> (word_bits - 1 - i % word_bits) & 1);
     }
 };
 
-template<uint64_t n, class T>
-struct DecimalRepresentation<BigUnsigned<n, T>> {
+template<class A>
+struct HexDigits {
+    static const size_t size = word_bits / 4 * A::length;
+    static constexpr char at(size_t i) {
+        return hex_char(WordArray<A>::value[A::length - 1 - i / (word_bits / 4)]
+            >> (word_bits - 4 - 4 * (i % (word_bits / 4))) & 0xF);
+    }
+};
+
+constexpr word power_of_10(size_t k) {
+    return k == 0 ? 1 : 10 * power_of_10(k - 1);
+}
+
+// decimal digits per chunk, so that 10 ** chunk_digits fits into a word
+constexpr size_t chunk_digits = word_bits == 32 ? 9 : word_bits == 64 ? 18 : 38;
+
+// A in base 10 ** chunk_digits, most significant chunk first
+template<class A, word... chunks>
+struct DecimalChunks : DecimalChunks<
+    typename DivisionByWord<A, power_of_10(chunk_digits)>::Quotient,
+    DivisionByWord<A, power_of_10(chunk_digits)>::residue, chunks...> {
+    STATIC_BIGNUM_COST(
+        DivisionByWord<A, power_of_10(chunk_digits)>,
+        DecimalChunks<
+            typename DivisionByWord<A, power_of_10(chunk_digits)>::Quotient,
+            DivisionByWord<A, power_of_10(chunk_digits)>::residue, chunks...>);
+};
+
+template<word... chunks>
+struct DecimalChunks<Zero, chunks...> {
+    static const size_t count = sizeof...(chunks);
+    static constexpr word value[] = {chunks...};
+    STATIC_BIGNUM_COST();
+};
+
+template<word... chunks>
+constexpr word DecimalChunks<Zero, chunks...>::value[];
+
+template<>
+struct DecimalChunks<Zero> : DecimalChunks<Zero, 0> {};
+
+constexpr size_t decimal_length(word x) {
+    return x < 10 ? 1 : 1 + decimal_length(x / 10);
+}
+
+// character i of the decimal string made of chunks, the first one having
+// top_length digits and the rest exactly chunk_digits
+constexpr char decimal_char(const word* chunks, size_t top_length, size_t i) {
+    return hex_char(i < top_length
+        ? chunks[0] / power_of_10(top_length - 1 - i) % 10
+        : chunks[1 + (i - top_length) / chunk_digits]
+            / power_of_10(chunk_digits - 1 - (i - top_length) % chunk_digits) % 10);
+}
+
+template<class A>
+struct DecimalDigits {
 private:
-    static const uint64_t modulo = 1000000000ULL * 1000000000ULL;
-    static const uint64_t modulo_log = 18;
-    using D = Division<BigUnsigned<n, T>, BIGUNSIGNED_1(modulo)>;
-    using Q = typename D::Quotient;
-    using R = typename D::Residue;
-    static_assert(R::digit < modulo, "invalid division by power of 10");
+    using C = DecimalChunks<A>;
+    static const size_t top_length = decimal_length(C::value[0]);
+public:
+    static const size_t size = top_length + chunk_digits * (C::count - 1);
+    static constexpr char at(size_t i) {
+        return decimal_char(C::value, top_length, i);
+    }
+};
+
+template<int s, class G>
+struct SignedDigits {
+    static const size_t size = G::size + (s < 0 ? 1 : 0);
+    static constexpr char at(size_t i) {
+        return s > 0 ? G::at(i) : i == 0 ? '-' : G::at(i - 1);
+    }
+};
+
+template<class A>
+struct DecimalRepresentation : Representation<DecimalDigits<A>> {
+    STATIC_BIGNUM_COST(DecimalChunks<A>);
+    STATIC_BIGNUM_ASSERT_BUDGET(DecimalRepresentation, "DecimalRepresentation");
+};
+template<class A>
+struct HexRepresentation     : Representation<HexDigits<A>> {};
+template<class A>
+struct BinaryRepresentation  : Representation<BinaryDigits<A>> {};
+
+template<int s, class T>
+struct DecimalRepresentation<BigSigned<s, T>> : Representation<SignedDigits<s, DecimalDigits<T>>> {
+    STATIC_BIGNUM_COST(DecimalChunks<T>);
+};
+template<int s, class T>
+struct HexRepresentation<BigSigned<s, T>>     : Representation<SignedDigits<s, HexDigits<T>>> {};
+template<int s, class T>
+struct BinaryRepresentation<BigSigned<s, T>>  : Representation<SignedDigits<s, BinaryDigits<T>>> {};
+
+inline std::string Zero::bin(void) {
+    return BinaryRepresentation<Zero>::str();
+}
+
+inline std::string Zero::dec(void) {
+    return DecimalRepresentation<Zero>::str();
+}
+
+inline std::string Zero::hex(void) {
+    return HexRepresentation<Zero>::str();
+}
+
+constexpr const char* Zero::bin_c_str(void) {
+    return BinaryRepresentation<Zero>::c_str();
+}
+
+constexpr const char* Zero::dec_c_str(void) {
+    return DecimalRepresentation<Zero>::c_str();
+}
+
+constexpr const char* Zero::hex_c_str(void) {
+    return HexRepresentation<Zero>::c_str();
+}
+
+#if __cplusplus >= 201703L
+constexpr std::string_view Zero::bin_view(void) {
+    return BinaryRepresentation<Zero>::view();
+}
+
+constexpr std::string_view Zero::dec_view(void) {
+    return DecimalRepresentation<Zero>::view();
+}
+
+constexpr std::string_view Zero::hex_view(void) {
+    return HexRepresentation<Zero>::view();
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////
+///////////////////////////////// parsing /////////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// Numbers are parsed from S::chars[0], ..., S::chars[S::size - 1], which may
+// contain ' digit separators. Digits are cut into chunks that fit into a
+// word: power of two radixes give the words themselves, decimal chunks are
+// accumulated with one ProductByWord per chunk.
+
+template<char... c>
+struct Chars {
+    static const size_t size = sizeof...(c);
+    static constexpr char chars[] = {c..., '\0'};
+};
+
+template<char... c>
+constexpr char Chars<c...>::chars[];
+
+template<bool... b>
+struct AllOf : std::is_same<AllOf<b..., true>, AllOf<true, b...>> {};
+
+constexpr int digit_value(char c) {
+    return c >= '0' && c <= '9' ? c - '0'
+         : c >= 'a' && c <= 'f' ? c - 'a' + 10
+         : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+}
+
+#if __cplusplus >= 201402L
+constexpr size_t digit_count(const char* s, size_t size) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i)
+        count += s[i] != '\'' ? 1 : 0;
+    return count;
+}
+
+// position of digit k in s, having count digits among size characters
+constexpr size_t digit_position(const char* s, size_t size, size_t count, size_t k) {
+    if (count == size)
+        return k;
+    for (size_t i = 0;; ++i)
+        if (s[i] != '\'' && k-- == 0)
+            return i;
+}
+#else
+// C++11 literals have no digit separators
+constexpr size_t digit_count(const char* s, size_t size) {
+    return size;
+}
+
+constexpr size_t digit_position(const char* s, size_t size, size_t count, size_t k) {
+    return k;
+}
+#endif
+
+// first digit and length of chunk k out of count digits, counting chunks of
+// chunk_length digits from the least significant one
+constexpr size_t chunk_begin(size_t count, size_t chunk_length, size_t k) {
+    return count > (k + 1) * chunk_length ? count - (k + 1) * chunk_length : 0;
+}
+
+constexpr size_t chunk_size(size_t count, size_t chunk_length, size_t k) {
+    return count - k * chunk_length - chunk_begin(count, chunk_length, k);
+}
+
+// value of `count` digits of s in base radix starting at position i
+constexpr word chunk_value(const char* s, size_t i, size_t count, word radix, word acc = 0) {
+    return count == 0 ? acc
+        : s[i] == '\'' ? chunk_value(s, i + 1, count, radix, acc)
+        : chunk_value(s, i + 1, count - 1, radix, acc * radix + static_cast<word>(digit_value(s[i])));
+}
+
+constexpr bool chunk_valid(const char* s, size_t i, size_t count, word radix) {
+    return count == 0 ? true
+        : s[i] == '\'' ? chunk_valid(s, i + 1, count, radix)
+        : digit_value(s[i]) >= 0 && static_cast<word>(digit_value(s[i])) < radix
+            && chunk_valid(s, i + 1, count - 1, radix);
+}
+
+// digits in base 2 ** radix_bits, word k made of chunk k
+template<class S, size_t radix_bits,
+         size_t count = digit_count(S::chars, S::size),
+         class I = typename MakeIndexSequence<
+             (count + word_bits / radix_bits - 1) / (word_bits / radix_bits)>::Result>
+struct ParsePowerOfTwo;
+
+template<class S, size_t radix_bits, size_t count, size_t... k>
+struct ParsePowerOfTwo<S, radix_bits, count, IndexSequence<k...>> {
+private:
+    static const size_t per_word = word_bits / radix_bits;
+    static constexpr word radix = word(1) << radix_bits;
 public:
-    static std::string str(void ){
-        std::string tail = DecimalRepresentation<Q>::str();
-        if(tail == "0") tail = "";
-        std::string curr = std::to_string(R::digit);
-        if(tail != "")
-            while(curr.size() < modulo_log)
-                curr = "0" + curr;
-        return tail + curr;
+    static_assert(count > 0, "number without digits");
+    static_assert(AllOf<chunk_valid(S::chars,
+        digit_position(S::chars, S::size, count, chunk_begin(count, per_word, k)),
+        chunk_size(count, per_word, k), radix)...>::value, "invalid digit");
+    using Result = typename PackWords<chunk_value(S::chars,
+        digit_position(S::chars, S::size, count, chunk_begin(count, per_word, k)),
+        chunk_size(count, per_word, k), radix)...>::Result;
+};
+
+template<class S> struct ParseHex    : ParsePowerOfTwo<S, 4> {};
+template<class S> struct ParseBinary : ParsePowerOfTwo<S, 1> {};
+
+// A * 10 ** chunk_digits + chunk for every chunk, most significant first
+template<class A, word... chunks>
+struct DecimalAccumulate { using Result = A; };
+
+template<class A, word chunk, word... chunks>
+struct DecimalAccumulate<A, chunk, chunks...> : DecimalAccumulate<
+    typename ProductByWord<A, power_of_10(chunk_digits), chunk>::Result, chunks...> {};
+
+template<class S,
+         size_t count = digit_count(S::chars, S::size),
+         class I = typename MakeIndexSequence<(count + chunk_digits - 1) / chunk_digits>::Result>
+struct ParseDecimal;
+
+template<class S, size_t count, size_t... k>
+struct ParseDecimal<S, count, IndexSequence<k...>> {
+private:
+    static const size_t chunks = sizeof...(k);
+public:
+    static_assert(count > 0, "number without digits");
+    static_assert(AllOf<chunk_valid(S::chars,
+        digit_position(S::chars, S::size, count, chunk_begin(count, chunk_digits, k)),
+        chunk_size(count, chunk_digits, k), 10)...>::value, "invalid digit");
+    using Result = typename DecimalAccumulate<Zero, chunk_value(S::chars,
+        digit_position(S::chars, S::size, count, chunk_begin(count, chunk_digits, chunks - 1 - k)),
+        chunk_size(count, chunk_digits, chunks - 1 - k), 10)...>::Result;
+};
+
+// integer literal: decimal, 0x hexadecimal or 0b binary
+template<char... c> struct Literal         : ParseDecimal<Chars<c...>> {};
+template<char... c> struct Literal<'0', 'x', c...> : ParseHex<Chars<c...>> {};
+template<char... c> struct Literal<'0', 'X', c...> : ParseHex<Chars<c...>> {};
+template<char... c> struct Literal<'0', 'b', c...> : ParseBinary<Chars<c...>> {};
+template<char... c> struct Literal<'0', 'B', c...> : ParseBinary<Chars<c...>> {};
+
+template<char... c>
+struct Literal<'0', c...> {
+    static_assert(sizeof...(c) == 0, "octal literals are not supported");
+    using Result = Zero;
+};
+
+namespace literals {
+
+// decltype(0x1234_sbn) is the number itself
+template<char... c>
+constexpr typename Literal<c...>::Result operator""_sbn() {
+    return {};
+}
+
+} // namespace literals
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+template<size_t n>
+struct FixedString {
+    char chars[n] = {};
+    constexpr FixedString(const char (&s)[n]) {
+        for (size_t i = 0; i < n; ++i)
+            chars[i] = s[i];
     }
 };
 
+// s without its trailing NUL and, if skip_prefix, a leading 0x or 0X
+template<FixedString s, bool skip_prefix = false>
+struct StringChars {
+    static constexpr size_t prefix =
+        skip_prefix && sizeof(s.chars) > 2 && s.chars[0] == '0' && (s.chars[1] == 'x' || s.chars[1] == 'X') ? 2 : 0;
+    static constexpr size_t size = sizeof(s.chars) - 1 - prefix;
+    static constexpr const char* chars = s.chars + prefix;
+};
+
+template<FixedString s> using FromHex = typename ParseHex<StringChars<s, true>>::Result;
+template<FixedString s> using FromDec = typename ParseDecimal<StringChars<s>>::Result;
+#endif
+
 ///////////////////////////////////////////////////////////////////////////
 /////////////////////////////// algorithms ////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////
@@ -625,15 +2308,17 @@ struct EuclideanAlgorithmImplementation {
 private:
     using Q = typename Division<R_prev, R_curr>::Quotient;
     using R = typename Division<R_prev, R_curr>::Residue;
+    using QS = Product<Q, S_curr>;
+    using QT = Product<Q, T_curr>;
+    using NextS = Difference<S_prev, typename QS::Result>;
+    using NextT = Difference<T_prev, typename QT::Result>;
     using RecursiveCall = EuclideanAlgorithmImplementation<
-        R_curr, R,
-        S_curr, typename Difference<S_prev, typename Product<Q, S_curr>::Result>::Result,
-        T_curr, typename Difference<T_prev, typename Product<Q, T_curr>::Result>::Result
-    >;
+        R_curr, R, S_curr, typename NextS::Result, T_curr, typename NextT::Result>;
 public:
     using GCD = typename RecursiveCall::GCD;
     using S   = typename RecursiveCall::S;
     using T   = typename RecursiveCall::T;
+    STATIC_BIGNUM_COST(Division<R_prev, R_curr>, QS, QT, NextS, NextT, RecursiveCall);
 };
 
 template<class R_prev, class S_prev, class S_curr, class T_prev, class T_curr>
@@ -641,19 +2326,154 @@ struct EuclideanAlgorithmImplementation<R_prev, PositiveZero, S_prev, S_curr, T_
     using GCD = R_prev;
     using S   = S_prev;
     using T   = T_prev;
+    STATIC_BIGNUM_COST();
 };
 template<class R_prev, class S_prev, class S_curr, class T_prev, class T_curr>
 struct EuclideanAlgorithmImplementation<R_prev, NegativeZero, S_prev, S_curr, T_prev, T_curr> {
     using GCD = R_prev;
     using S   = S_prev;
     using T   = T_prev;
+    STATIC_BIGNUM_COST();
+};
+
+// Lehmer's algorithm: runs of Euclidean steps are done on the leading
+// word_bits - 1 bits of both numbers alone (Knuth's algorithm L), and only
+// the resulting 2 x 2 matrix of single word cofactors is applied to the
+// whole numbers. A run that cannot decide even one quotient falls back to a
+// full division step.
+
+// magnitudes of the cofactors A, B, C, D of algorithm L; their signs
+// alternate, A and D being negative after an odd number of steps
+struct LehmerMatrix {
+    word a, b, c, d;
+    bool odd;
+};
+
+// x + A, y + C (first) and x + B, y + D (second) bound the next quotient
+constexpr bool lehmer_done(word x, word y, LehmerMatrix m) {
+    return m.odd ? x < m.a || y <= m.d : x < m.b || y <= m.c;
+}
+
+constexpr word lehmer_first(word x, word y, LehmerMatrix m) {
+    return m.odd ? (x - m.a) / (y + m.c) : (x + m.a) / (y - m.c);
+}
+
+constexpr word lehmer_second(word x, word y, LehmerMatrix m) {
+    return m.odd ? (x + m.b) / (y - m.d) : (x - m.b) / (y + m.d);
+}
+
+constexpr LehmerMatrix lehmer_step(LehmerMatrix m, word q) {
+    return LehmerMatrix{m.c, m.d, m.a + q * m.c, m.b + q * m.d, !m.odd};
+}
+
+constexpr LehmerMatrix lehmer_matrix(word x, word y, LehmerMatrix m = LehmerMatrix{1, 0, 0, 1, false}) {
+    return lehmer_done(x, y, m) || lehmer_first(x, y, m) != lehmer_second(x, y, m) ? m
+        : lehmer_matrix(y, x - lehmer_first(x, y, m) * y, lehmer_step(m, lehmer_first(x, y, m)));
+}
+
+// bits offset, ..., offset + word_bits - 1 of the number with digits lo, hi
+constexpr word bits_from(word lo, word hi, size_t offset) {
+    return offset == 0 ? lo : lo >> offset | hi << (word_bits - offset);
+}
+
+// U >> shift and V >> shift, the former taking word_bits - 1 bits
+template<class U, class V>
+struct LehmerLeading {
+private:
+    static const size_t bits = U::length * word_bits - leading_zeros(Digit<U, U::length - 1>::value);
+    static const size_t shift = bits > word_bits - 1 ? bits - (word_bits - 1) : 0;
+public:
+    static const word x = bits_from(
+        Digit<U, shift / word_bits>::value, Digit<U, shift / word_bits + 1>::value, shift % word_bits);
+    static const word y = bits_from(
+        Digit<V, shift / word_bits>::value, Digit<V, shift / word_bits + 1>::value, shift % word_bits);
+};
+
+// U, V = V, U mod V
+template<class U, class V, class T0, class T1>
+struct LehmerDivisionStep {
+private:
+    using D = Division<U, V>;
+public:
+    using NextU  = V;
+    using NextV  = typename D::Residue;
+    using NextT0 = T1;
+    using NextT1 = typename MulAdd<typename D::Quotient, T1, T0>::Result;
+    static const bool odd = true;
+    STATIC_BIGNUM_COST(D, MulAdd<typename D::Quotient, T1, T0>);
+};
+
+// U, V = A * U + B * V, C * U + D * V
+template<class U, class V, class T0, class T1, word a, word b, word c, word d, bool matrix_odd>
+struct LehmerMatrixStep {
+private:
+    using AU = typename ProductByWord<U, a>::Result;
+    using BV = typename ProductByWord<V, b>::Result;
+    using CU = typename ProductByWord<U, c>::Result;
+    using DV = typename ProductByWord<V, d>::Result;
+    using DifferenceU = typename std::conditional<matrix_odd, Difference<BV, AU>, Difference<AU, BV>>::type;
+    using DifferenceV = typename std::conditional<matrix_odd, Difference<CU, DV>, Difference<DV, CU>>::type;
+    using AT0 = ProductByWord<T0, a>;
+    using CT0 = ProductByWord<T0, c>;
+    using SumT0 = AddProductByWord<typename AT0::Result, T1, b>;
+    using SumT1 = AddProductByWord<typename CT0::Result, T1, d>;
+public:
+    using NextU  = typename DifferenceU::Result;
+    using NextV  = typename DifferenceV::Result;
+    using NextT0 = typename SumT0::Result;
+    using NextT1 = typename SumT1::Result;
+    static const bool odd = matrix_odd;
+    STATIC_BIGNUM_COST(
+        ProductByWord<U, a>, ProductByWord<V, b>, ProductByWord<U, c>, ProductByWord<V, d>,
+        DifferenceU, DifferenceV, AT0, CT0, SumT0, SumT1);
+};
+
+// Euclidean algorithm on U >= V with Lehmer's steps. T0 and T1 are the
+// magnitudes of the cofactors of the original V in U and V, T0 being
+// positive if odd; starting with Zero and Zero skips them altogether.
+template<class U, class V, class T0, class T1, bool odd>
+struct LehmerGCD {
+private:
+    using L = LehmerLeading<U, V>;
+    static constexpr LehmerMatrix m = lehmer_matrix(L::x, L::y);
+    using Step = typename std::conditional<
+        m.b == 0,
+        LehmerDivisionStep<U, V, T0, T1>,
+        LehmerMatrixStep<U, V, T0, T1, m.a, m.b, m.c, m.d, m.odd>
+    >::type;
+    using Next = LehmerGCD<
+        typename Step::NextU, typename Step::NextV,
+        typename Step::NextT0, typename Step::NextT1, odd != Step::odd>;
+public:
+    using GCD = typename Next::GCD;
+    using T   = typename Next::T;
+    static const bool positive = Next::positive;
+    STATIC_BIGNUM_COST(Step, Next);
+};
+
+template<class U, class T0, class T1, bool odd>
+struct LehmerGCD<U, Zero, T0, T1, odd> {
+    using GCD = U;
+    using T   = T0;
+    static const bool positive = odd || std::is_same<T0, Zero>::value;
+    STATIC_BIGNUM_COST();
+};
+
+// gcd(A, B) of unsigned numbers, without Bezout coefficients
+template<class A, class B>
+struct GreatestCommonDivisor {
+private:
+    using L = LehmerGCD<typename Max<A, B>::Result, typename Min<A, B>::Result, Zero, Zero, false>;
+public:
+    using Result = typename L::GCD;
+    STATIC_BIGNUM_COST(L);
 };
 
 template<class A, class B>
 struct EuclideanAlgorithm;
 
 template<int a_s, int b_s, class a_T, class b_T>
-struct EuclideanAlgorithm<BigSigned<a_s, a_T>, BigSigned<b_s, b_T>> {
+struct SignedEuclideanAlgorithm {
     using A = BigSigned<a_s, a_T>;
     using B = BigSigned<b_s, b_T>;
 private:
@@ -671,21 +2491,2559 @@ public:
         swap, typename Implementation::T, typename Implementation::S>::type;
     using T = typename std::conditional<
         swap, typename Implementation::S, typename Implementation::T>::type;
+    STATIC_BIGNUM_COST(Implementation);
+};
+
+// positive numbers go through Lehmer's algorithm
+template<int a_s, int b_s, class a_T, class b_T>
+struct EuclideanAlgorithm<BigSigned<a_s, a_T>, BigSigned<b_s, b_T>>
+    : std::conditional<
+        (a_s > 0 && b_s > 0 && !std::is_same<a_T, Zero>::value && !std::is_same<b_T, Zero>::value),
+        EuclideanAlgorithm<a_T, b_T>,
+        SignedEuclideanAlgorithm<a_s, b_s, a_T, b_T>
+    >::type {
+    using A = BigSigned<a_s, a_T>;
+    using B = BigSigned<b_s, b_T>;
+    STATIC_BIGNUM_ASSERT_BUDGET(EuclideanAlgorithm, "EuclideanAlgorithm");
 };
 
-template<uint64_t a_n, uint64_t b_n, class a_T, class b_T>
+template<word a_n, word b_n, class a_T, class b_T>
 struct EuclideanAlgorithm<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
     using A = BigUnsigned<a_n, a_T>;
     using B = BigUnsigned<b_n, b_T>;
 private:
-    using Implementation = EuclideanAlgorithm<
-        typename Signed<A>::Result,
-        typename Signed<B>::Result
-    >;
+    static const bool swap = GreaterThan<B, A>::value;
+    using U = typename Max<A, B>::Result;
+    using V = typename Min<A, B>::Result;
+    using L = LehmerGCD<U, V, Zero, One, false>;
+    // U * S_U = GCD - V * T_V, S_U and T_V having opposite signs
+    using VT = Product<V, typename L::T>;
+    using GCDMinusVT = typename std::conditional<
+        L::positive,
+        Difference<typename VT::Result, typename L::GCD>,
+        MulAdd<V, typename L::T, typename L::GCD>
+    >::type;
+    using DivisionSU = Division<typename GCDMinusVT::Result, U>;
+    using SU = typename DivisionSU::Quotient;
+    using SignedSU = BigSigned<L::positive && !std::is_same<SU, Zero>::value ? -1 : 1, SU>;
+    using SignedTV = BigSigned<L::positive ? 1 : -1, typename L::T>;
 public:
-    using GCD = typename Implementation::GCD;
-    using S   = typename Implementation::S;
-    using T   = typename Implementation::T;
+    // GCD = A * S + B * T
+    using GCD = BigSigned<1, typename L::GCD>;
+    using S   = typename std::conditional<swap, SignedTV, SignedSU>::type;
+    using T   = typename std::conditional<swap, SignedSU, SignedTV>::type;
+    STATIC_BIGNUM_COST(L, VT, GCDMinusVT, DivisionSU);
+    STATIC_BIGNUM_ASSERT_BUDGET(EuclideanAlgorithm, "EuclideanAlgorithm");
+};
+
+template<class A> struct Identity { using Result = A; };
+
+// A ** e by squaring, one level per bit of e
+template<class A, uint64_t e>
+struct Pow {
+private:
+    using Half   = typename Pow<A, e / 2>::Result;
+    using Square = typename Product<Half, Half>::Result;
+public:
+    using Result = typename std::conditional<
+        (e & 1) != 0, Product<Square, A>, Identity<Square>
+    >::type::Result;
+};
+
+template<class A> struct Pow<A, 0> { using Result = One; };
+template<class A> struct Pow<A, 1> { using Result = A; };
+
+template<int s, class T, uint64_t e>
+struct Pow<BigSigned<s, T>, e> {
+    using Result = BigSigned<(e & 1) != 0 ? s : 1, typename Pow<T, e>::Result>;
+};
+template<int s, class T> struct Pow<BigSigned<s, T>, 0> { using Result = BigSigned<1, One>; };
+template<int s, class T> struct Pow<BigSigned<s, T>, 1> { using Result = BigSigned<s, T>; };
+
+// R ** (2 ** (bit + 1)) * A ** (n mod 2 ** (bit + 1)) mod M, most significant bit first
+template<class R, class A, class M, word n, int bit>
+struct PowModBits {
+private:
+    using Square = typename MulMod<R, R, M>::Result;
+    using Next = typename std::conditional<
+        ((n >> bit) & 1) != 0, MulMod<Square, A, M>, Identity<Square>
+    >::type::Result;
+public:
+    using Result = typename PowModBits<Next, A, M, n, bit - 1>::Result;
+};
+
+template<class R, class A, class M, word n>
+struct PowModBits<R, A, M, n, -1> { using Result = R; };
+
+template<class R, class A, class M, class E> struct PowModWords;
+
+template<class R, class A, class M>
+struct PowModWords<R, A, M, Zero> { using Result = R; };
+
+template<class R, class A, class M, word n, class T>
+struct PowModWords<R, A, M, BigUnsigned<n, T>> {
+    using Result = typename PowModBits<
+        typename PowModWords<R, A, M, T>::Result, A, M, n, word_bits - 1
+    >::Result;
+};
+
+// A ** E mod M for unsigned A, E and M, reducing after every product, so
+// that no intermediate result is longer than twice M
+template<class A, class E, class M>
+struct PowMod {
+    using Result = typename PowModWords<
+        typename Division<One, M>::Residue,
+        typename Division<A, M>::Residue,
+        M, typename Optimize<E>::Result
+    >::Result;
+};
+
+// X such that A * X = 1 mod M, from the cofactor of A mod M in Lehmer's
+// algorithm; the cofactor of M is never needed
+template<class A, class M>
+struct ModInverse {
+private:
+    using Residue = typename Division<A, M>::Residue;
+    static_assert(!std::is_same<Residue, Zero>::value, "ModInverse argument is not invertible");
+    using L = LehmerGCD<M, Residue, Zero, One, false>;
+    static_assert(std::is_same<typename L::GCD, One>::value, "ModInverse argument is not invertible");
+public:
+    using Result = typename std::conditional<
+        L::positive, Identity<typename L::T>, Difference<M, typename L::T>
+    >::type::Result;
+};
+
+// whether x ** k <= limit, without overflowing
+constexpr bool power_at_most(word x, size_t k, word limit) {
+    return k == 0 || x == 1 ? limit >= 1
+         : x == 0 || (x <= limit && power_at_most(x, k - 1, limit / x));
+}
+
+// floor(x ** (1 / k)) of a word, one bit at a time
+constexpr word word_root(word x, size_t k, int bit = word_bits - 1, word r = 0) {
+    return bit < 0 ? r
+         : word_root(x, k, bit - 1, power_at_most(r | word(1) << bit, k, x) ? r | word(1) << bit : r);
+}
+
+// Newton's iteration for floor(A ** (1 / k)) from an X above it: every
+// step decreases X until it reaches the root, and the first step that does
+// not decrease it stops the iteration
+template<class A, size_t k, class X>
+struct IRootStep {
+private:
+    using Q = typename Division<A, typename Pow<X, k - 1>::Result>::Quotient;
+    using Next = typename Division<
+        typename Sum<typename ProductByWord<X, k - 1>::Result, Q>::Result, BigUnsigned<k>
+    >::Quotient;
+public:
+    using Result = typename std::conditional<
+        GreaterThanOrEqualTo<Next, X>::value, Identity<X>, IRootStep<A, k, Next>
+    >::type::Result;
+};
+
+// the first X is (floor(top ** (1 / k)) + 1) << j for top = A >> (k * j),
+// the leading word of A cut at a multiple of k bits; it is above the root
+// and good to about word_bits / k bits, so that Newton's iteration converges
+// quadratically from the first step when k is small
+template<class A, size_t k>
+struct IRootImplementation {
+private:
+    static const size_t bits = A::length * word_bits - leading_zeros(Digit<A, A::length - 1>::value);
+    static const size_t j = bits > word_bits ? (bits - word_bits + k - 1) / k : 0;
+    static const word top = Digit<typename ShiftRight<A, k * j>::Result, 0>::value;
+    using X = typename ShiftLeft<BigUnsigned<word_root(top, k) + 1>, j>::Result;
+public:
+    using Result = typename IRootStep<A, k, X>::Result;
+};
+
+template<size_t k>
+struct IRootImplementation<Zero, k> { using Result = Zero; };
+
+// floor(A ** (1 / k)) for an unsigned A
+template<class A, size_t k>
+struct IRoot {
+    static_assert(k > 0, "IRoot of degree 0");
+    using Result = typename std::conditional<
+        k == 1,
+        Optimize<A>,
+        IRootImplementation<typename Optimize<A>::Result, k == 1 ? 2 : k>
+    >::type::Result;
+};
+
+// floor(sqrt(A)) for an unsigned A
+template<class A>
+struct ISqrt : IRoot<A, 2> {};
+
+#ifdef STATIC_BIGNUM_USE_MACRO
+#define SBN_POW(x, e)        static_bignum::Pow<x, e>::Result
+#define SBN_POWMOD(x, e, m)  static_bignum::PowMod<x, e, m>::Result
+#define SBN_MODINV(x, m)     static_bignum::ModInverse<x, m>::Result
+#define SBN_GCD(x, y)        static_bignum::GreatestCommonDivisor<x, y>::Result
+#define SBN_ISQRT(x)         static_bignum::ISqrt<x>::Result
+#define SBN_IROOT(x, k)      static_bignum::IRoot<x, k>::Result
+#endif
+
+///////////////////////////////////////////////////////////////////////////
+////////////////////////////// power tables ///////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// Tables of successive powers for runtime code: PowerTable<Base, count>
+// holds Base ** i and SquareTable<Base, count> holds Base ** (2 ** i) for
+// i < count, both modulo an optional Modulus. Every entry is a single
+// product, or MulMod, of the previous one, and the table is one cache line
+// aligned word[count][limbs] array in read-only data, entry i at value[i],
+// least significant word first and padded with zero words.
+
+// A * B, or A * B mod M unless M is Zero
+template<class A, class B, class M>
+struct ModularProduct : MulMod<A, B, M> {};
+template<class A, class B>
+struct ModularProduct<A, B, Zero> : Product<A, B> {};
+
+template<class Base, class M>
+struct PowerStep {
+    template<class E> using Next = ModularProduct<E, Base, M>;
+};
+
+template<class M>
+struct SquareStep {
+    template<class E> using Next = ModularProduct<E, E, M>;
+};
+
+// type i of Es...
+template<size_t i, class... Es> struct PackElement;
+template<class E, class... Es>
+struct PackElement<0, E, Es...> { using Result = E; };
+template<size_t i, class E, class... Es>
+struct PackElement<i, E, Es...> : PackElement<i - 1, Es...> {};
+
+// word k % limbs of entry k / limbs of the table
+template<size_t limbs, class... Es>
+struct PowerTableWords {
+    static constexpr const word* rows[] = {Es::data()...};
+    static constexpr size_t lengths[] = {Es::length...};
+    static constexpr word at(size_t k) {
+        return k % limbs < lengths[k / limbs] ? rows[k / limbs][k % limbs] : 0;
+    }
+};
+
+template<size_t limbs, class... Es>
+constexpr const word* PowerTableWords<limbs, Es...>::rows[];
+template<size_t limbs, class... Es>
+constexpr size_t PowerTableWords<limbs, Es...>::lengths[];
+
+template<class I, class... Es> struct PowerTableArray;
+
+template<size_t... k, class... Es>
+struct PowerTableArray<IndexSequence<k...>, Es...> {
+    static const size_t count = sizeof...(Es);
+    static const size_t limbs = sizeof...(k) / count;
+    alignas(64) static constexpr word value[count][limbs] = {PowerTableWords<limbs, Es...>::at(k)...};
+
+    // entry i as a static number
+    template<size_t i> using Entry = typename PackElement<i, Es...>::Result;
+
+    static inline const word* entry(size_t i) {
+        return value[i];
+    }
+};
+
+template<size_t... k, class... Es>
+alignas(64) constexpr word PowerTableArray<IndexSequence<k...>, Es...>
+    ::value[PowerTableArray<IndexSequence<k...>, Es...>::count][PowerTableArray<IndexSequence<k...>, Es...>::limbs];
+
+// the table of E, Step::Next<E>, ... with count entries after Es...
+template<class Step, class E, size_t count, class... Es>
+struct PowerTableEntries : PowerTableEntries<
+    Step, typename Step::template Next<E>::Result, count - 1, Es..., E> {
+    STATIC_BIGNUM_COST(
+        typename Step::template Next<E>,
+        PowerTableEntries<Step, typename Step::template Next<E>::Result, count - 1, Es..., E>);
+};
+
+template<class Step, class E, class... Es>
+struct PowerTableEntries<Step, E, 1, Es...> : PowerTableArray<
+    typename MakeIndexSequence<(sizeof...(Es) + 1) * max_of(1, E::length, Es::length...)>::Result, Es..., E> {
+    STATIC_BIGNUM_COST();
+};
+
+// Base ** 0 mod M
+template<class M> struct PowerTableFirst { using Result = typename Division<One, M>::Residue; };
+template<> struct PowerTableFirst<Zero> { using Result = One; };
+
+template<class Base, class M>
+struct PowerTableBase { using Result = typename Division<typename Optimize<Base>::Result, M>::Residue; };
+template<class Base>
+struct PowerTableBase<Base, Zero> { using Result = typename Optimize<Base>::Result; };
+
+// Base ** i mod Modulus for i < count, Modulus = Zero for none
+template<class Base, size_t count, class Modulus = Zero>
+struct PowerTable : PowerTableEntries<
+    PowerStep<typename PowerTableBase<Base, Modulus>::Result, Modulus>,
+    typename PowerTableFirst<Modulus>::Result, count> {
+    static_assert(count > 0, "PowerTable needs at least one entry");
+};
+
+// Base ** (2 ** i) mod Modulus for i < count, Modulus = Zero for none
+template<class Base, size_t count, class Modulus = Zero>
+struct SquareTable : PowerTableEntries<
+    SquareStep<Modulus>, typename PowerTableBase<Base, Modulus>::Result, count> {
+    static_assert(count > 0, "SquareTable needs at least one entry");
+};
+
+///////////////////////////////////////////////////////////////////////////
+////////////////////////////// floating point /////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// Conversion to binary floating point types, rounded to nearest with ties
+// to even, as a correctly rounded strtod would, overflowing to infinity and
+// going through subnormals on underflow. It is constexpr all the way, so
+// FloatingValue<A, F>::value and A::to_double() are literal constants.
+
+// bits of the number of n words at d, leading zero words allowed
+constexpr size_t bit_length(const word* d, size_t n) {
+    return n == 0 ? 0
+         : d[n - 1] == 0 ? bit_length(d, n - 1)
+         : n * word_bits - leading_zeros(d[n - 1]);
+}
+
+// bit i, zero past the end
+constexpr bool bit_at(const word* d, size_t n, size_t i) {
+    return i / word_bits < n && ((d[i / word_bits] >> (i % word_bits)) & 1) != 0;
+}
+
+constexpr bool any_words(const word* d, size_t n) {
+    return n == 0 ? false
+         : n == 1 ? d[0] != 0
+         : any_words(d, n / 2) || any_words(d + n / 2, n - n / 2);
+}
+
+// whether any bit below position i is set
+constexpr bool any_bits_below(const word* d, size_t n, size_t i) {
+    return i / word_bits >= n ? any_words(d, n)
+         : any_words(d, i / word_bits) || (d[i / word_bits] & ((word(1) << (i % word_bits)) - 1)) != 0;
+}
+
+// the word_bits bits from position i on
+constexpr word bits_from(const word* d, size_t n, size_t i) {
+    return (i / word_bits < n ? d[i / word_bits] >> (i % word_bits) : 0) |
+        (i % word_bits != 0 && i / word_bits + 1 < n ? d[i / word_bits + 1] << (word_bits - i % word_bits) : 0);
+}
+
+// the 32 bits from position i on
+constexpr uint32_t bits_32(const word* d, size_t n, size_t i) {
+    return static_cast<uint32_t>(bits_from(d, n, i));
+}
+
+// bits [i, i + count) as an F, 32 at a time; exact as long as count is
+// within the precision of F
+template<class F>
+constexpr F bits_value(const word* d, size_t n, size_t i, size_t count) {
+    return count == 0 ? F(0)
+         : count <= 32 ? static_cast<F>(bits_32(d, n, i) & (uint32_t(0xFFFFFFFF) >> (32 - count)))
+         : static_cast<F>(bits_32(d, n, i)) + F(4294967296.0) * bits_value<F>(d, n, i + 32, count - 32);
+}
+
+template<class F>
+constexpr F binary_power_step(F half, F base, uint64_t e) {
+    return half * half * (e % 2 != 0 ? base : F(1));
+}
+
+// base ** e by squaring; every step is exact for base 2 or 1/2
+template<class F>
+constexpr F binary_power(F base, uint64_t e) {
+    return e == 0 ? F(1) : binary_power_step(binary_power(base, e / 2), base, e);
+}
+
+template<class F>
+constexpr F power_of_2(int64_t e) {
+    return e < 0 ? binary_power(F(0.5), static_cast<uint64_t>(-e)) : binary_power(F(2), static_cast<uint64_t>(e));
+}
+
+// m * 2 ** e for an m of at most the precision of F, so the product is
+// exact unless the result, below 2 ** top, overflows
+template<class F>
+constexpr F scaled(F m, int64_t top, int64_t e) {
+    return top > std::numeric_limits<F>::max_exponent ? std::numeric_limits<F>::infinity() : m * power_of_2<F>(e);
+}
+
+// m rounded up to 2 ** digits carries into the next binade
+template<class F>
+constexpr F rounded(F m, int64_t top, int64_t e) {
+    return scaled(m, m == power_of_2<F>(std::numeric_limits<F>::digits) ? top + 1 : top, e);
+}
+
+// drops the cut lowest of length bits, rounding to nearest even; sticky
+// stands for a nonzero remainder below bit 0
+template<class F>
+constexpr F rounded_bits(const word* d, size_t n, size_t length, int64_t offset, bool sticky, size_t cut) {
+    return rounded<F>(
+        (cut < length ? bits_value<F>(d, n, cut, length - cut) : F(0)) +
+        (cut > 0 && bit_at(d, n, cut - 1) && (sticky || bit_at(d, n, cut) || any_bits_below(d, n, cut - 1)) ? F(1) : F(0)),
+        static_cast<int64_t>(length) + offset, static_cast<int64_t>(cut) + offset);
+}
+
+template<class F>
+constexpr size_t floating_cut(int64_t lowest, int64_t offset) {
+    return lowest > offset ? static_cast<size_t>(lowest - offset) : 0;
+}
+
+// F keeps digits bits from the top of a number, but none below its
+// smallest subnormal
+template<class F>
+constexpr size_t floating_cut(size_t length, int64_t offset) {
+    return floating_cut<F>(
+        static_cast<int64_t>(length) + offset > std::numeric_limits<F>::min_exponent
+            ? static_cast<int64_t>(length) + offset - std::numeric_limits<F>::digits
+            : static_cast<int64_t>(std::numeric_limits<F>::min_exponent) - std::numeric_limits<F>::digits,
+        offset);
+}
+
+// the number of n words at d times 2 ** offset, rounded to F; sticky adds
+// a nonzero remainder below bit 0, which the caller keeps below the cut
+template<class F>
+constexpr F floating_value(const word* d, size_t n, int64_t offset = 0, bool sticky = false) {
+    return rounded_bits<F>(d, n, bit_length(d, n), offset, sticky, floating_cut<F>(bit_length(d, n), offset));
+}
+
+// A rounded to the floating point type F
+template<class A, class F>
+struct FloatingValue {
+    static_assert(std::numeric_limits<F>::radix == 2, "only binary floating point types are supported");
+    static constexpr F value = floating_value<F>(A::data(), A::length);
+};
+
+template<class A, class F>
+constexpr F FloatingValue<A, F>::value;
+
+template<int s, class T, class F>
+struct FloatingValue<BigSigned<s, T>, F> {
+    static constexpr F value = s < 0 ? -FloatingValue<T, F>::value : FloatingValue<T, F>::value;
+};
+
+template<int s, class T, class F>
+constexpr F FloatingValue<BigSigned<s, T>, F>::value;
+
+constexpr double Zero::to_double(void) {
+    return 0;
+}
+constexpr long double Zero::to_long_double(void) {
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////
+///////////////////////////////// rationals ///////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// magnitude and sign of a signed or unsigned number
+template<class A>
+struct Magnitude {
+    using Result = typename Optimize<A>::Result;
+    static const int sign = 1;
+    static const bool is_signed = false;
+};
+
+template<int s, class T>
+struct Magnitude<BigSigned<s, T>> {
+    using Result = typename Optimize<T>::Result;
+    static const int sign = s;
+    static const bool is_signed = true;
+};
+
+// Num / Den in lowest terms: both are divided by their gcd, and the sign,
+// if any, goes to Numerator, which is signed if Num or Den is. Denominator
+// is unsigned and nonzero.
+template<class Num, class Den = One>
+struct Rational {
+private:
+    using N = typename Magnitude<Num>::Result;
+    using D = typename Magnitude<Den>::Result;
+    static_assert(!std::is_same<D, Zero>::value, "Rational with a zero denominator");
+    using G = GreatestCommonDivisor<N, D>;
+    using ReduceN = Division<N, typename G::Result>;
+    using ReduceD = Division<D, typename G::Result>;
+public:
+    static const int sign = std::is_same<N, Zero>::value ? 1 : Magnitude<Num>::sign * Magnitude<Den>::sign;
+    using Numerator = typename std::conditional<
+        Magnitude<Num>::is_signed || Magnitude<Den>::is_signed,
+        BigSigned<sign, typename ReduceN::Quotient>,
+        typename ReduceN::Quotient
+    >::type;
+    using Denominator = typename ReduceD::Quotient;
+    static constexpr double to_double(void) {
+        return FloatingValue<Rational, double>::value;
+    }
+    static constexpr long double to_long_double(void) {
+        return FloatingValue<Rational, long double>::value;
+    }
+    STATIC_BIGNUM_COST(G, ReduceN, ReduceD);
+};
+
+// N / D for unsigned N and a nonzero D, from a quotient of at least
+// digits + 2 bits and the remainder as the sticky bit
+template<class N, class D, class F>
+struct QuotientFloatingValue {
+private:
+    static const int64_t shift = static_cast<int64_t>(std::numeric_limits<F>::digits + 2)
+        + static_cast<int64_t>(bit_length(D::data(), D::length))
+        - static_cast<int64_t>(bit_length(N::data(), N::length));
+    using Scaled = Division<
+        typename ShiftLeft<N, (shift > 0 ? shift : 0)>::Result,
+        typename ShiftLeft<D, (shift < 0 ? -shift : 0)>::Result>;
+    using Q = typename Scaled::Quotient;
+public:
+    static constexpr F value = floating_value<F>(
+        Q::data(), Q::length, -shift, !std::is_same<typename Scaled::Residue, Zero>::value);
+};
+
+template<class N, class D, class F>
+constexpr F QuotientFloatingValue<N, D, F>::value;
+
+template<class Num, class Den, class F>
+struct FloatingValue<Rational<Num, Den>, F> {
+private:
+    using R = Rational<Num, Den>;
+    using V = QuotientFloatingValue<
+        typename Magnitude<typename R::Numerator>::Result, typename R::Denominator, F>;
+public:
+    static_assert(std::numeric_limits<F>::radix == 2, "only binary floating point types are supported");
+    static constexpr F value = R::sign < 0 ? -V::value : V::value;
+};
+
+template<class Num, class Den, class F>
+constexpr F FloatingValue<Rational<Num, Den>, F>::value;
+
+// the numerator as a signed number, for arithmetic
+template<class R>
+using SignedNumerator = BigSigned<R::sign, typename Magnitude<typename R::Numerator>::Result>;
+
+template<class a_N, class a_D>
+struct Minus<Rational<a_N, a_D>> {
+private:
+    using A = Rational<a_N, a_D>;
+public:
+    using Result = Rational<BigSigned<-A::sign, typename Magnitude<typename A::Numerator>::Result>, typename A::Denominator>;
+};
+
+template<class a_N, class a_D, class b_N, class b_D>
+struct Sum<Rational<a_N, a_D>, Rational<b_N, b_D>> {
+private:
+    using A = Rational<a_N, a_D>;
+    using B = Rational<b_N, b_D>;
+    using AD = Product<SignedNumerator<A>, BigSigned<1, typename B::Denominator>>;
+    using BD = Product<SignedNumerator<B>, BigSigned<1, typename A::Denominator>>;
+    using N = Sum<typename AD::Result, typename BD::Result>;
+    using D = Product<typename A::Denominator, typename B::Denominator>;
+public:
+    using Result = Rational<typename N::Result, typename D::Result>;
+    STATIC_BIGNUM_COST(AD, BD, N, D, Result);
+};
+
+template<class a_N, class a_D, class b_N, class b_D>
+struct Difference<Rational<a_N, a_D>, Rational<b_N, b_D>> {
+private:
+    using S = Sum<Rational<a_N, a_D>, typename Minus<Rational<b_N, b_D>>::Result>;
+public:
+    using Result = typename S::Result;
+    STATIC_BIGNUM_COST(S);
+};
+
+template<class a_N, class a_D, class b_N, class b_D>
+struct Product<Rational<a_N, a_D>, Rational<b_N, b_D>> {
+private:
+    using A = Rational<a_N, a_D>;
+    using B = Rational<b_N, b_D>;
+    using N = Product<SignedNumerator<A>, SignedNumerator<B>>;
+    using D = Product<typename A::Denominator, typename B::Denominator>;
+public:
+    using Result = Rational<typename N::Result, typename D::Result>;
+    STATIC_BIGNUM_COST(N, D, Result);
+};
+
+///////////////////////////////////////////////////////////////////////////
+//////////////////////////// binary polynomials ///////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// Unsigned numbers double as polynomials over GF(2), bit i being the
+// coefficient of x ** i. And, Or and Xor work on the bits, Xor being both
+// sum and difference of polynomials, and ClMul, PolyDivision and
+// PolyPowMod are the carry-less counterparts of Product, Division and
+// PowMod. Like the integer operations they take and return canonical
+// numbers.
+
+template<class A, class B> struct Xor;
+template<> struct Xor<Zero, Zero> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct Xor<Zero, BigUnsigned<n, T>> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct Xor<BigUnsigned<n, T>, Zero> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
+template<word a_n, class a_T, word b_n, class b_T>
+struct Xor<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
+    using Result = typename Prepend<a_n ^ b_n, typename Xor<a_T, b_T>::Result>::Result;
+    STATIC_BIGNUM_COST(Xor<a_T, b_T>);
+};
+
+template<class A, class B> struct Or;
+template<> struct Or<Zero, Zero> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct Or<Zero, BigUnsigned<n, T>> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct Or<BigUnsigned<n, T>, Zero> { using Result = BigUnsigned<n, T>; STATIC_BIGNUM_COST(); };
+template<word a_n, class a_T, word b_n, class b_T>
+struct Or<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
+    using Result = BigUnsigned<a_n | b_n, typename Or<a_T, b_T>::Result>;
+    STATIC_BIGNUM_COST(Or<a_T, b_T>);
+};
+
+template<class A, class B> struct And;
+template<> struct And<Zero, Zero> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct And<Zero, BigUnsigned<n, T>> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word n, class T>
+struct And<BigUnsigned<n, T>, Zero> { using Result = Zero; STATIC_BIGNUM_COST(); };
+template<word a_n, class a_T, word b_n, class b_T>
+struct And<BigUnsigned<a_n, a_T>, BigUnsigned<b_n, b_T>> {
+    using Result = typename Prepend<a_n & b_n, typename And<a_T, b_T>::Result>::Result;
+    STATIC_BIGNUM_COST(And<a_T, b_T>);
+};
+
+// carry-less product of two words, low and high word
+constexpr word clmul_lo(word a, word b, size_t i = 0) {
+    return i == word_bits ? 0 : ((b >> i & 1) != 0 ? a << i : 0) ^ clmul_lo(a, b, i + 1);
+}
+constexpr word clmul_hi(word a, word b, size_t i = 1) {
+    return i == word_bits ? 0 : ((b >> i & 1) != 0 ? a >> (word_bits - i) : 0) ^ clmul_hi(a, b, i + 1);
+}
+
+template<class A, word w, word carry = 0> struct ClMulByWord;
+
+template<word w, word carry>
+struct ClMulByWord<Zero, w, carry> {
+    using Result = typename Prepend<carry, Zero>::Result;
+    STATIC_BIGNUM_COST();
+};
+
+template<word n, class T>
+struct ClMulByWord<BigUnsigned<n, T>, 0, 0> { using Result = Zero; STATIC_BIGNUM_COST(); };
+
+template<word n, class T, word w, word carry>
+struct ClMulByWord<BigUnsigned<n, T>, w, carry> {
+    using Result = BigUnsigned<clmul_lo(n, w) ^ carry, typename ClMulByWord<T, w, clmul_hi(n, w)>::Result>;
+    STATIC_BIGNUM_COST(ClMulByWord<T, w, clmul_hi(n, w)>);
+};
+
+// A * B over GF(2), one word of B at a time
+template<class A, class B> struct ClMul;
+
+template<class A>
+struct ClMul<A, Zero> { using Result = Zero; STATIC_BIGNUM_COST(); };
+
+template<class A, word n, class T>
+struct ClMul<A, BigUnsigned<n, T>> {
+private:
+    using Low  = ClMulByWord<A, n>;
+    using High = ClMul<A, T>;
+    using X    = Xor<typename Low::Result, typename Prepend<0, typename High::Result>::Result>;
+public:
+    using Result = typename X::Result;
+    STATIC_BIGNUM_COST(Low, High, X);
+};
+
+constexpr word low_mask(size_t c) {
+    return c >= word_bits ? word_max : (word(1) << c) - 1;
+}
+
+// the c <= word_bits leading coefficients of a nonzero polynomial of
+// length bits, the leading one in bit c - 1
+constexpr word leading_bits(const word* d, size_t n, size_t length, size_t c) {
+    return length >= c ? bits_from(d, n, length - c) & low_mask(c) : bits_from(d, n, 0) << (c - length);
+}
+
+// the c leading coefficients of the quotient of polynomials whose c
+// leading coefficients are a and b, bit c - 1 of both being set; the
+// other coefficients of the divisor cannot change them
+constexpr word poly_quotient_word(word a, word b, size_t c, size_t i = 0, word q = 0) {
+    return i == c ? q
+         : (a >> (c - 1 - i) & 1) != 0
+             ? poly_quotient_word(a ^ b >> i, b, c, i + 1, q | word(1) << (c - 1 - i))
+             : poly_quotient_word(a, b, c, i + 1, q);
+}
+
+// long division taking a word of quotient coefficients per step: the
+// multiple of B cancelling the leading c coefficients of A is Xored out
+template<class A, class B, class Q,
+    bool done = (bit_length(A::data(), A::length) < bit_length(B::data(), B::length))>
+struct PolyDivisionStep {
+private:
+    static const size_t a_bits = bit_length(A::data(), A::length);
+    static const size_t b_bits = bit_length(B::data(), B::length);
+    static const size_t c = a_bits - b_bits < word_bits ? a_bits - b_bits + 1 : word_bits;
+    static const size_t shift = a_bits - b_bits + 1 - c;
+    static const word q = poly_quotient_word(
+        leading_bits(A::data(), A::length, a_bits, c), leading_bits(B::data(), B::length, b_bits, c), c);
+    using Multiple = ShiftLeft<typename ClMulByWord<B, q>::Result, shift>;
+    using NextA = Xor<A, typename Multiple::Result>;
+    using NextQ = Xor<Q, typename ShiftLeft<BigUnsigned<q>, shift>::Result>;
+    using Next = PolyDivisionStep<typename NextA::Result, B, typename NextQ::Result>;
+public:
+    using Quotient = typename Next::Quotient;
+    using Residue  = typename Next::Residue;
+    STATIC_BIGNUM_COST(ClMulByWord<B, q>, Multiple, NextA, NextQ, Next);
+};
+
+template<class A, class B, class Q>
+struct PolyDivisionStep<A, B, Q, true> {
+    using Quotient = Q;
+    using Residue  = A;
+    STATIC_BIGNUM_COST();
+};
+
+// A = Quotient * B + Residue over GF(2), Residue of lower degree than B
+template<class A, class B>
+struct PolyDivision {
+private:
+    using Step = PolyDivisionStep<typename Optimize<A>::Result, typename Optimize<B>::Result, Zero>;
+    static_assert(!std::is_same<typename Optimize<B>::Result, Zero>::value, "polynomial division by zero");
+public:
+    using Quotient = typename Step::Quotient;
+    using Residue  = typename Step::Residue;
+    STATIC_BIGNUM_COST(Step);
+};
+
+template<class A, class P>
+struct PolyMod {
+    using Result = typename PolyDivision<A, P>::Residue;
+    STATIC_BIGNUM_COST(PolyDivision<A, P>);
+};
+
+template<class A, class B, class P>
+struct PolyMulMod {
+    using Result = typename PolyMod<typename ClMul<A, B>::Result, P>::Result;
+    STATIC_BIGNUM_COST(ClMul<A, B>, PolyMod<typename ClMul<A, B>::Result, P>);
+};
+
+// A ** k mod P for an A already reduced mod P
+template<class A, uint64_t k, class P>
+struct PolyPowModImplementation {
+private:
+    using Half   = typename PolyPowModImplementation<A, k / 2, P>::Result;
+    using Square = typename PolyMulMod<Half, Half, P>::Result;
+public:
+    using Result = typename std::conditional<
+        (k & 1) != 0, PolyMulMod<Square, A, P>, Identity<Square>
+    >::type::Result;
+};
+
+template<class A, class P>
+struct PolyPowModImplementation<A, 0, P> { using Result = typename PolyMod<One, P>::Result; };
+template<class A, class P>
+struct PolyPowModImplementation<A, 1, P> { using Result = A; };
+
+// A ** k mod P over GF(2), by squaring; PolyPowMod<BigUnsigned<2>, k, P>
+// is x ** k mod P
+template<class A, uint64_t k, class P>
+struct PolyPowMod {
+    using Result = typename PolyPowModImplementation<typename PolyMod<A, P>::Result, k, P>::Result;
+};
+
+constexpr word reverse_word(word x, size_t i = 0, word r = 0) {
+    return i == word_bits ? r : reverse_word(x >> 1, i + 1, r << 1 | (x & 1));
+}
+
+// word i of the lowest bits bits in reverse order
+constexpr word reflected_word(const word* d, size_t n, size_t bits, size_t i) {
+    return reverse_word(bits >= (i + 1) * word_bits
+        ? bits_from(d, n, bits - (i + 1) * word_bits)
+        : bits_from(d, n, 0) << ((i + 1) * word_bits - bits));
+}
+
+// the lowest bits bits of A in reverse order, the form in which reflected
+// CRCs and GHASH keep their polynomials
+template<class A, size_t bits, class I = typename MakeIndexSequence<(bits + word_bits - 1) / word_bits>::Result>
+struct Reflect;
+
+template<class A, size_t bits, size_t... i>
+struct Reflect<A, bits, IndexSequence<i...>> {
+    using Result = typename PackWords<reflected_word(A::data(), A::length, bits, i)...>::Result;
+    STATIC_BIGNUM_COST();
+};
+
+#ifdef STATIC_BIGNUM_USE_MACRO
+#define SBN_AND(x, y)           static_bignum::And<x, y>::Result
+#define SBN_OR(x, y)            static_bignum::Or<x, y>::Result
+#define SBN_XOR(x, y)           static_bignum::Xor<x, y>::Result
+#define SBN_CLMUL(x, y)         static_bignum::ClMul<x, y>::Result
+#define SBN_POLYDIV(x, y)       static_bignum::PolyDivision<x, y>::Quotient
+#define SBN_POLYMOD(x, y)       static_bignum::PolyDivision<x, y>::Residue
+#define SBN_POLYPOWMOD(x, k, p) static_bignum::PolyPowMod<x, k, p>::Result
+#endif
+
+///////////////////////////////////////////////////////////////////////////
+////////////////////////////////// crc tables /////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// Lookup tables and folding constants of a CRC whose generator P, with its
+// x ** width term, is a static number of degree 8 to 64. Table entries
+// are computed by constexpr functions on the low 64 bits of P rather than
+// one PolyMod each, which would make a slicing-by-16 table thousands of
+// instantiations; folding constants go through PolyPowMod.
+
+constexpr uint64_t low_64(const word* d, size_t n) {
+    return static_cast<uint64_t>(n > 0 ? d[0] : 0)
+         | (word_bits < 64 && n > 1 ? static_cast<uint64_t>(d[1]) << (word_bits % 64) : 0);
+}
+
+constexpr uint64_t mask_64(size_t width) {
+    return width >= 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+}
+
+// r * x ** k mod P for r of degree below width, p being P without its
+// x ** width term
+constexpr uint64_t crc_shift(uint64_t r, uint64_t p, size_t width, size_t k) {
+    return k > 8 ? crc_shift(crc_shift(r, p, width, k / 2), p, width, k - k / 2)
+         : k == 0 ? r
+         : crc_shift(((r << 1) & mask_64(width)) ^ ((r >> (width - 1) & 1) != 0 ? p : 0), p, width, k - 1);
+}
+
+constexpr uint64_t reflect_64(uint64_t x, size_t bits, uint64_t r = 0) {
+    return bits == 0 ? r : reflect_64(x >> 1, bits - 1, r << 1 | (x & 1));
+}
+
+// b * x ** (width + 8 * k) mod P, or for reflected CRCs the same with b
+// and the result bit reflected, for b a single bit j
+constexpr uint64_t crc_table_bit(uint64_t p, size_t width, bool reflected, size_t k, size_t j) {
+    return reflected
+        ? reflect_64(crc_shift(uint64_t(1) << (7 - j), p, width, width + 8 * k), width)
+        : crc_shift(uint64_t(1) << j, p, width, width + 8 * k);
+}
+
+template<size_t width>
+struct CrcWord {
+    using Result = typename std::conditional<width <= 8, uint8_t,
+        typename std::conditional<width <= 16, uint16_t,
+        typename std::conditional<width <= 32, uint32_t, uint64_t>::type>::type>::type;
+};
+
+// the entries of single bits of slice k, as constants rather than an
+// array, whose elements GCC evaluates anew on every access
+template<class P, bool reflected, size_t k>
+struct CrcTableRow {
+    static const size_t width = bit_length(P::data(), P::length) - 1;
+    static_assert(width >= 8 && width <= 64, "CrcTable needs a polynomial of degree 8 to 64");
+    static const uint64_t p = low_64(P::data(), P::length) & mask_64(width);
+    static const uint64_t b0 = crc_table_bit(p, width, reflected, k, 0);
+    static const uint64_t b1 = crc_table_bit(p, width, reflected, k, 1);
+    static const uint64_t b2 = crc_table_bit(p, width, reflected, k, 2);
+    static const uint64_t b3 = crc_table_bit(p, width, reflected, k, 3);
+    static const uint64_t b4 = crc_table_bit(p, width, reflected, k, 4);
+    static const uint64_t b5 = crc_table_bit(p, width, reflected, k, 5);
+    static const uint64_t b6 = crc_table_bit(p, width, reflected, k, 6);
+    static const uint64_t b7 = crc_table_bit(p, width, reflected, k, 7);
+    // entries are linear in b, so each is the sum of the entries of its bits
+    static constexpr uint64_t entry(size_t b) {
+        return (b & 1 ? b0 : 0) ^ (b & 2 ? b1 : 0) ^ (b & 4 ? b2 : 0) ^ (b & 8 ? b3 : 0)
+            ^ (b & 16 ? b4 : 0) ^ (b & 32 ? b5 : 0) ^ (b & 64 ? b6 : 0) ^ (b & 128 ? b7 : 0);
+    }
+};
+
+// Slicing-by-slices tables of the CRC with generator P: value[k][b] is
+// the CRC register after byte b followed by k zero bytes, starting from
+// zero, so that value[0] is the usual byte-at-a-time table. Entries are
+// the smallest unsigned type holding width bits, slices * 256 of them in
+// one cache line aligned array.
+template<class P, size_t slices, bool reflected,
+    class I = typename MakeIndexSequence<slices * 256>::Result>
+struct CrcTable;
+
+template<class P, size_t slices, bool reflected, size_t... i>
+struct CrcTable<P, slices, reflected, IndexSequence<i...>> {
+    static const size_t width = CrcTableRow<P, reflected, 0>::width;
+    using value_type = typename CrcWord<width>::Result;
+    alignas(64) static constexpr value_type value[slices][256] = {
+        static_cast<value_type>(CrcTableRow<P, reflected, i / 256>::entry(i % 256))...
+    };
+};
+
+template<class P, size_t slices, bool reflected, size_t... i>
+alignas(64) constexpr typename CrcTable<P, slices, reflected, IndexSequence<i...>>::value_type
+    CrcTable<P, slices, reflected, IndexSequence<i...>>::value[slices][256];
+
+template<class P, size_t n, bool reflected>
+struct FoldConstantPolynomial {
+    using Result = typename PolyPowMod<BigUnsigned<2>, n, P>::Result;
+};
+
+template<class P, size_t n>
+struct FoldConstantPolynomial<P, n, true> {
+    using Result = typename Reflect<typename PolyPowMod<BigUnsigned<2>, n - 1, P>::Result, 64>::Result;
+};
+
+// x ** n mod P as a carry-less multiplier. For reflected CRCs it is bit
+// reflected in 64 bits, and x ** (n - 1) mod P, since the product of two
+// reflected 64-bit operands comes out multiplied by x.
+template<class P, size_t n, bool reflected>
+struct FoldConstant {
+    using Result = typename FoldConstantPolynomial<P, n, reflected>::Result;
+    static const uint64_t value = low_64(Result::data(), Result::length);
+};
+
+// Constants for folding 128-bit blocks of a message distance bits ahead
+// with carry-less multiplication, one pair per distance: value[j][0]
+// multiplies the 64 higher degree coefficients of a block, value[j][1] the
+// lower ones, and their sum is the folded block. Each pair is one aligned
+// 128-bit load; for reflected CRCs, whose blocks hold the higher degree
+// half in the low 64 bits, value[j][0] is the low half of that load too.
+template<class P, bool reflected, size_t... distances>
+struct CrcFolding {
+    static_assert(bit_length(P::data(), P::length) - 1 <= 64, "CrcFolding needs a polynomial of degree up to 64");
+    alignas(16) static constexpr uint64_t value[sizeof...(distances)][2] = {
+        {FoldConstant<P, distances + 64, reflected>::value, FoldConstant<P, distances, reflected>::value}...
+    };
+};
+
+template<class P, bool reflected, size_t... distances>
+alignas(16) constexpr uint64_t CrcFolding<P, reflected, distances...>::value[sizeof...(distances)][2];
+
+///////////////////////////////////////////////////////////////////////////
+///////////////////////// montgomery multiplication /////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// inverse of an odd x modulo 2 ** word_bits by Newton's iteration;
+// x * x = 1 mod 8, so x is correct in 3 bits and every step doubles that
+constexpr word word_inverse(word x, word y, int steps) {
+    return steps == 0 ? y : word_inverse(x, y * (2 - x * y), steps - 1);
+}
+
+constexpr word word_inverse(word x) {
+    return word_inverse(x, x, 6);
+}
+
+// a * b + c + d never overflows two words
+inline word mul_add(word a, word b, word c, word d, word& high) {
+#ifdef STATIC_BIGNUM_DOUBLE_WORD
+    // one widening multiplication gives both halves
+    const double_word t = static_cast<double_word>(a) * b + c + d;
+    high = static_cast<word>(t >> word_bits);
+    return static_cast<word>(t);
+#else
+    word h = mul_hi(a, b);
+    word l = mul_lo(a, b) + c;
+    h += l < c ? 1 : 0;
+    l += d;
+    h += l < d ? 1 : 0;
+    high = h;
+    return l;
+#endif
+}
+
+// r = a - b for n-word arrays, returns the borrow
+inline word subtract_words(word* r, const word* a, const word* b, size_t n) {
+    word borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const word d = a[i] - b[i];
+        const word next = (a[i] < b[i] || d < borrow) ? 1 : 0;
+        r[i] = d - borrow;
+        borrow = next;
+    }
+    return borrow;
+}
+
+// a >= b for n-word arrays
+inline bool greater_or_equal_words(const word* a, const word* b, size_t n) {
+    for (size_t i = n; i-- > 0;)
+        if (a[i] != b[i])
+            return a[i] > b[i];
+    return true;
+}
+
+// r = a * b, r has an + bn words and must not alias a or b
+inline void multiply_words(word* r, const word* a, size_t an, const word* b, size_t bn) {
+    for (size_t i = 0; i < an + bn; ++i)
+        r[i] = 0;
+    for (size_t j = 0; j < bn; ++j) {
+        word carry = 0;
+        for (size_t i = 0; i < an; ++i)
+            r[i + j] = mul_add(a[i], b[j], r[i + j], carry, carry);
+        r[an + j] = carry;
+    }
+}
+
+// Montgomery arithmetic modulo an odd static N with R = 2 ** (word_bits * length).
+// R mod N, R ** 2 mod N and -1 / N mod 2 ** word_bits are computed at compile time;
+// mul, sqr and pow work at runtime on arrays of exactly length words with
+// every loop bound known at compile time. Arguments must be reduced mod N
+// and may alias the result.
+template<class N>
+struct Montgomery {
+    using Modulus = typename Optimize<N>::Result;
+    static const size_t length = Modulus::length;
+    static_assert(length > 0 && (Modulus::digit & 1) == 1, "Montgomery modulus must be odd");
+    using R  = typename Division<typename ShiftLeft<One, word_bits * length>::Result, Modulus>::Residue;
+    using R2 = typename Division<typename ShiftLeft<One, 2 * word_bits * length>::Result, Modulus>::Residue;
+    static const word inverse = 0 - word_inverse(Modulus::digit);
+
+    static inline const word* modulus(void) {
+        return PaddedWordArray<Modulus, length>::value;
+    }
+    // R mod N, the Montgomery form of 1
+    static inline const word* one(void) {
+        return PaddedWordArray<R, length>::value;
+    }
+
+    // r = a * b / R mod N
+    static inline void mul(word* r, const word* a, const word* b) {
+        const word* n = modulus();
+        word t[length + 2] = {};
+        for (size_t i = 0; i < length; ++i) {
+            word carry = 0;
+            for (size_t j = 0; j < length; ++j)
+                t[j] = mul_add(a[j], b[i], t[j], carry, carry);
+            t[length] += carry;
+            t[length + 1] = t[length] < carry ? 1 : 0;
+            const word m = t[0] * inverse;
+            mul_add(m, n[0], t[0], 0, carry);
+            for (size_t j = 1; j < length; ++j)
+                t[j - 1] = mul_add(m, n[j], t[j], carry, carry);
+            t[length - 1] = t[length] + carry;
+            t[length] = t[length + 1] + (t[length - 1] < carry ? 1 : 0);
+        }
+        reduce(r, t);
+    }
+
+    static inline void sqr(word* r, const word* a) {
+        mul(r, a, a);
+    }
+
+    // r = a ** e / R ** (e - 1) mod N, e given by e_length words, least
+    // significant first; a and r are in Montgomery form
+    static inline void pow(word* r, const word* a, const word* e, size_t e_length) {
+        word base[length], result[length];
+        std::memcpy(base, a, sizeof(base));
+        std::memcpy(result, one(), sizeof(result));
+        for (size_t i = e_length; i-- > 0;)
+            for (int bit = word_bits - 1; bit >= 0; --bit) {
+                sqr(result, result);
+                if ((e[i] >> bit) & 1)
+                    mul(result, result, base);
+            }
+        std::memcpy(r, result, sizeof(result));
+    }
+
+    // r = a * R mod N
+    static inline void to_montgomery(word* r, const word* a) {
+        mul(r, a, PaddedWordArray<R2, length>::value);
+    }
+
+    // r = a / R mod N
+    static inline void from_montgomery(word* r, const word* a) {
+        word unit[length] = {1};
+        mul(r, a, unit);
+    }
+
+private:
+    // r = t mod N for t < 2 * N given by length + 1 words
+    static inline void reduce(word* r, const word* t) {
+        word d[length];
+        const word borrow = subtract_words(d, t, modulus(), length);
+        const bool smaller = t[length] == 0 && borrow != 0;
+        for (size_t j = 0; j < length; ++j)
+            r[j] = smaller ? t[j] : d[j];
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////
+//////////////////////////// barrett reduction ////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// Reduction modulo a static M of k = M::length words by Barrett's method:
+// mu = P ** 2k / M is computed at compile time, so at runtime a 2k-word x
+// needs two truncated products and at most two subtractions of M.
+template<class M>
+struct BarrettReducer {
+    using Modulus = typename Optimize<M>::Result;
+    static const size_t length = Modulus::length;
+    using Mu = typename Division<typename ShiftLeft<One, 2 * word_bits * length>::Result, Modulus>::Quotient;
+    static_assert(length > 0 && Mu::length == length + 1,
+        "Barrett modulus must not be zero or a power of 2 ** word_bits");
+
+    static inline const word* modulus(void) {
+        return PaddedWordArray<Modulus, length + 1>::value;
+    }
+
+    // q = x / M (length + 1 words), r = x % M (length words), x has 2 * length words
+    static inline void divide(word* q, word* r, const word* x) {
+        const word* m = modulus();
+        // q3 = (x / P ** (k - 1)) * mu / P ** (k + 1) is at most 2 less than x / M
+        word q2[2 * length + 2];
+        multiply_words(q2, x + length - 1, length + 1, PaddedWordArray<Mu, length + 1>::value, length + 1);
+        const word* q3 = q2 + length + 1;
+        // x - q3 * M mod P ** (k + 1)
+        word rem[length + 1], p[length + 1];
+        for (size_t i = 0; i <= length; ++i)
+            p[i] = 0;
+        for (size_t j = 0; j < length; ++j) {
+            word carry = 0;
+            for (size_t i = 0; i + j <= length; ++i)
+                p[i + j] = mul_add(q3[i], m[j], p[i + j], carry, carry);
+        }
+        subtract_words(rem, x, p, length + 1);
+        word extra = 0;
+        for (int i = 0; i < 2; ++i)
+            if (greater_or_equal_words(rem, m, length + 1)) {
+                subtract_words(rem, rem, m, length + 1);
+                ++extra;
+            }
+        for (size_t i = 0; i <= length; ++i) {
+            q[i] = q3[i] + extra;
+            extra = q[i] < extra ? 1 : 0;
+        }
+        std::memcpy(r, rem, length * sizeof(word));
+    }
+
+    // r = x % M, x has 2 * length words
+    static inline void reduce(word* r, const word* x) {
+        word q[length + 1];
+        divide(q, r, x);
+    }
+};
+
+// (u1 * P + u0) / d for a normalized d (top bit set), u1 < d and
+// v = (P ** 2 - 1) / d - P, by Moller and Granlund's algorithm
+inline word divide_preinverted(word u1, word u0, word d, word v, word& r) {
+    word q0 = mul_lo(v, u1) + u0;
+    word q1 = mul_hi(v, u1) + u1 + 1 + (q0 < u0 ? 1 : 0);
+    word rest = u0 - q1 * d;
+    if (rest > q0) {
+        --q1;
+        rest += d;
+    }
+    if (rest >= d) {
+        ++q1;
+        rest -= d;
+    }
+    r = rest;
+    return q1;
+}
+
+// division by a static single word: normalizing shift and reciprocal are
+// computed at compile time
+template<word d>
+struct WordInvariantDivisor {
+    static_assert(d != 0, "division by zero");
+    static const size_t length = 1;
+    static const int shift = leading_zeros(d);
+    static const word normalized = d << shift;
+    static const word reciprocal = div_word(~normalized, word_max, normalized);
+
+    // q = x / d (n words), r = x % d (1 word)
+    static inline void divide(word* q, word* r, const word* x, size_t n) {
+        word rest = shift == 0 || n == 0 ? 0 : x[n - 1] >> (word_bits - shift);
+        for (size_t i = n; i-- > 0;) {
+            const word u0 = shift == 0 ? x[i]
+                : (x[i] << shift) | (i > 0 ? x[i - 1] >> (word_bits - shift) : 0);
+            q[i] = divide_preinverted(rest, u0, normalized, reciprocal, rest);
+        }
+        *r = rest >> shift;
+    }
+};
+
+// division by a static number of k words, k digits of base P ** k at a time
+template<class D>
+struct BarrettInvariantDivisor {
+    using Reducer = BarrettReducer<D>;
+    static const size_t length = Reducer::length;
+
+    // q = x / D (n words), r = x % D (length words)
+    static inline void divide(word* q, word* r, const word* x, size_t n) {
+        word u[2 * length], chunk_quotient[length + 1], rest[length] = {};
+        for (size_t c = (n + length - 1) / length; c-- > 0;) {
+            for (size_t j = 0; j < length; ++j) {
+                u[j] = c * length + j < n ? x[c * length + j] : 0;
+                u[length + j] = rest[j];
+            }
+            Reducer::divide(chunk_quotient, rest, u);
+            for (size_t j = 0; j < length && c * length + j < n; ++j)
+                q[c * length + j] = chunk_quotient[j];
+        }
+        std::memcpy(r, rest, length * sizeof(word));
+    }
+};
+
+// division by P ** (length - 1), which only moves words
+template<size_t length_>
+struct WordShiftDivisor {
+    static const size_t length = length_;
+
+    // q = x / D (n words), r = x % D (length words)
+    static inline void divide(word* q, word* r, const word* x, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            q[i] = i + length - 1 < n ? x[i + length - 1] : 0;
+        for (size_t i = 0; i < length; ++i)
+            r[i] = i + 1 < length && i < n ? x[i] : 0;
+    }
+};
+
+// runtime division by a static D with all constants precomputed
+template<class D, class N = typename Optimize<D>::Result>
+struct InvariantDivisor : std::conditional<
+    N::length == 1,
+    WordInvariantDivisor<N::digit>,
+    typename std::conditional<
+        std::is_same<N, typename BigShiftLeft<One, (N::length > 1 ? N::length - 1 : 0)>::Result>::value,
+        WordShiftDivisor<N::length>,
+        BarrettInvariantDivisor<D>
+    >::type
+>::type {};
+
+///////////////////////////////////////////////////////////////////////////
+///////////////////////////// runtime numbers /////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// loops over the words of runtime numbers are unrolled completely
+#if defined(__clang__)
+#define STATIC_BIGNUM_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define STATIC_BIGNUM_UNROLL _Pragma("GCC unroll 64")
+#else
+#define STATIC_BIGNUM_UNROLL
+#endif
+
+// a + b + carry and a - b - borrow for an incoming carry or borrow of 0 or
+// 1, which is replaced by the outgoing one
+inline word add_with_carry(word a, word b, word& carry) {
+#if defined(STATIC_BIGNUM_BUILTIN_ADDC)
+    unsigned long long carry_out;
+    const word r = __builtin_addcll(a, b, carry, &carry_out);
+    carry = carry_out;
+    return r;
+#elif defined(STATIC_BIGNUM_ADDCARRY_INTRINSICS)
+    unsigned long long r;
+    carry = _addcarry_u64(static_cast<unsigned char>(carry), a, b, &r);
+    return r;
+#else
+    const word partial = a + carry;
+    const word r = partial + b;
+    carry = (partial < carry ? 1 : 0) | (r < b ? 1 : 0);
+    return r;
+#endif
+}
+
+inline word subtract_with_borrow(word a, word b, word& borrow) {
+#if defined(STATIC_BIGNUM_BUILTIN_ADDC)
+    unsigned long long borrow_out;
+    const word r = __builtin_subcll(a, b, borrow, &borrow_out);
+    borrow = borrow_out;
+    return r;
+#elif defined(STATIC_BIGNUM_ADDCARRY_INTRINSICS)
+    unsigned long long r;
+    borrow = _subborrow_u64(static_cast<unsigned char>(borrow), a, b, &r);
+    return r;
+#else
+    const word partial = a - b;
+    const word r = partial - borrow;
+    borrow = (a < b ? 1 : 0) | (partial < borrow ? 1 : 0);
+    return r;
+#endif
+}
+
+// A runtime number of exactly `limbs` words, least significant first, with
+// arithmetic modulo 2 ** (word_bits * limbs). Every loop runs over the limb
+// count known at compile time and nothing is allocated. Static numbers
+// convert to Fixed constants at compile time, and mixed operations with
+// them use what is known about their digits.
+template<size_t limbs>
+struct Fixed {
+    static_assert(limbs > 0, "Fixed needs at least one word");
+    static const size_t length = limbs;
+    word words[limbs];
+
+    constexpr Fixed() : words{} {}
+    constexpr Fixed(Zero) : words{} {}
+    template<word n, class T>
+    constexpr Fixed(BigUnsigned<n, T> x) : Fixed(x, typename MakeIndexSequence<limbs>::Result()) {}
+    template<word... digits>
+    constexpr Fixed(FlatUnsigned<digits...> x) : Fixed(x, typename MakeIndexSequence<limbs>::Result()) {}
+
+    inline void write_to(word* dest) const {
+        std::memcpy(dest, words, limbs * sizeof(word));
+    }
+
+    inline bool is_zero(void) const {
+        word any = 0;
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < limbs; ++i)
+            any |= words[i];
+        return any == 0;
+    }
+
+private:
+    template<class X, size_t... i>
+    constexpr Fixed(X, IndexSequence<i...>) : words{X::get_digit(i)...} {
+        static_assert(X::length <= limbs, "static number does not fit into Fixed");
+    }
+};
+
+// r = a + b and r = a - b, returning the carry or borrow out of the top word
+template<size_t n>
+inline word add(Fixed<n>& r, const Fixed<n>& a, const Fixed<n>& b) {
+    word carry = 0;
+    STATIC_BIGNUM_UNROLL
+    for (size_t i = 0; i < n; ++i)
+        r.words[i] = add_with_carry(a.words[i], b.words[i], carry);
+    return carry;
+}
+
+template<size_t n>
+inline word subtract(Fixed<n>& r, const Fixed<n>& a, const Fixed<n>& b) {
+    word borrow = 0;
+    STATIC_BIGNUM_UNROLL
+    for (size_t i = 0; i < n; ++i)
+        r.words[i] = subtract_with_borrow(a.words[i], b.words[i], borrow);
+    return borrow;
+}
+
+// the full product of n + m words
+template<size_t n, size_t m>
+inline Fixed<n + m> multiply(const Fixed<n>& a, const Fixed<m>& b) {
+    Fixed<n + m> r;
+    STATIC_BIGNUM_UNROLL
+    for (size_t j = 0; j < m; ++j) {
+        word carry = 0;
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < n; ++i)
+            r.words[i + j] = mul_add(a.words[i], b.words[j], r.words[i + j], carry, carry);
+        r.words[n + j] = carry;
+    }
+    return r;
+}
+
+template<size_t n>
+inline Fixed<n> operator+(const Fixed<n>& a, const Fixed<n>& b) {
+    Fixed<n> r;
+    add(r, a, b);
+    return r;
+}
+
+template<size_t n>
+inline Fixed<n> operator-(const Fixed<n>& a, const Fixed<n>& b) {
+    Fixed<n> r;
+    subtract(r, a, b);
+    return r;
+}
+
+// the lowest n words of a * b
+template<size_t n>
+inline Fixed<n> operator*(const Fixed<n>& a, const Fixed<n>& b) {
+    Fixed<n> r;
+    STATIC_BIGNUM_UNROLL
+    for (size_t j = 0; j < n; ++j) {
+        word carry = 0;
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i + j < n; ++i)
+            r.words[i + j] = mul_add(a.words[i], b.words[j], r.words[i + j], carry, carry);
+    }
+    return r;
+}
+
+template<size_t n>
+inline Fixed<n> operator<<(const Fixed<n>& a, size_t shift) {
+    Fixed<n> r;
+    const size_t whole = shift / word_bits, bits = shift % word_bits;
+    STATIC_BIGNUM_UNROLL
+    for (size_t i = whole; i < n; ++i)
+        r.words[i] = a.words[i - whole] << bits
+            | (bits != 0 && i > whole ? a.words[i - whole - 1] >> (word_bits - bits) : 0);
+    return r;
+}
+
+template<size_t n>
+inline Fixed<n> operator>>(const Fixed<n>& a, size_t shift) {
+    Fixed<n> r;
+    const size_t whole = shift / word_bits, bits = shift % word_bits;
+    STATIC_BIGNUM_UNROLL
+    for (size_t i = 0; i + whole < n; ++i)
+        r.words[i] = a.words[i + whole] >> bits
+            | (bits != 0 && i + whole + 1 < n ? a.words[i + whole + 1] << (word_bits - bits) : 0);
+    return r;
+}
+
+template<size_t n>
+inline Fixed<n>& operator+=(Fixed<n>& a, const Fixed<n>& b) { add(a, a, b); return a; }
+template<size_t n>
+inline Fixed<n>& operator-=(Fixed<n>& a, const Fixed<n>& b) { subtract(a, a, b); return a; }
+template<size_t n>
+inline Fixed<n>& operator*=(Fixed<n>& a, const Fixed<n>& b) { return a = a * b; }
+template<size_t n>
+inline Fixed<n>& operator<<=(Fixed<n>& a, size_t shift) { return a = a << shift; }
+template<size_t n>
+inline Fixed<n>& operator>>=(Fixed<n>& a, size_t shift) { return a = a >> shift; }
+
+// -1, 0 or 1 as a is less than, equal to or greater than b
+template<size_t n>
+inline int compare(const Fixed<n>& a, const Fixed<n>& b) {
+    for (size_t i = n; i-- > 0;)
+        if (a.words[i] != b.words[i])
+            return a.words[i] < b.words[i] ? -1 : 1;
+    return 0;
+}
+
+template<size_t n>
+inline bool operator==(const Fixed<n>& a, const Fixed<n>& b) {
+    word diff = 0;
+    STATIC_BIGNUM_UNROLL
+    for (size_t i = 0; i < n; ++i)
+        diff |= a.words[i] ^ b.words[i];
+    return diff == 0;
+}
+
+template<size_t n> inline bool operator!=(const Fixed<n>& a, const Fixed<n>& b) { return !(a == b); }
+template<size_t n> inline bool operator< (const Fixed<n>& a, const Fixed<n>& b) { return compare(a, b) <  0; }
+template<size_t n> inline bool operator<=(const Fixed<n>& a, const Fixed<n>& b) { return compare(a, b) <= 0; }
+template<size_t n> inline bool operator> (const Fixed<n>& a, const Fixed<n>& b) { return compare(a, b) >  0; }
+template<size_t n> inline bool operator>=(const Fixed<n>& a, const Fixed<n>& b) { return compare(a, b) >= 0; }
+
+// r += a * d * P ** j modulo P ** n, for a digit d known to be 0, 1 or other
+template<size_t n>
+inline void add_row(word* r, const word* a, size_t j, word d, std::integral_constant<int, 0>) {}
+
+template<size_t n>
+inline void add_row(word* r, const word* a, size_t j, word d, std::integral_constant<int, 1>) {
+    word carry = 0;
+    STATIC_BIGNUM_UNROLL
+    for (size_t i = 0; i + j < n; ++i)
+        r[i + j] = add_with_carry(r[i + j], a[i], carry);
+}
+
+template<size_t n>
+inline void add_row(word* r, const word* a, size_t j, word d, std::integral_constant<int, 2>) {
+    word carry = 0;
+    STATIC_BIGNUM_UNROLL
+    for (size_t i = 0; i + j < n; ++i)
+        r[i + j] = mul_add(a[i], d, r[i + j], carry, carry);
+}
+
+// rows of a * X for a static X, starting with digit j
+template<class X, size_t j = 0> struct StaticMultiplier;
+
+template<size_t j>
+struct StaticMultiplier<Zero, j> {
+    template<size_t n>
+    static inline void add_to(word* r, const word* a) {}
+};
+
+template<word d, class T, size_t j>
+struct StaticMultiplier<BigUnsigned<d, T>, j> {
+    template<size_t n>
+    static inline void add_to(word* r, const word* a) {
+        add_row<n>(r, a, j, d, std::integral_constant<int, (j >= n || d == 0) ? 0 : d == 1 ? 1 : 2>());
+        StaticMultiplier<T, j + 1>::template add_to<n>(r, a);
+    }
+};
+
+template<size_t n, word d, class T>
+inline Fixed<n> operator*(const Fixed<n>& a, BigUnsigned<d, T>) {
+    Fixed<n> r;
+    StaticMultiplier<BigUnsigned<d, T>>::template add_to<n>(r.words, a.words);
+    return r;
+}
+
+template<size_t n, word d, class T>
+inline Fixed<n> operator*(BigUnsigned<d, T> x, const Fixed<n>& a) { return a * x; }
+
+template<size_t n, word d, class T>
+inline Fixed<n> operator+(const Fixed<n>& a, BigUnsigned<d, T> x) { return a + Fixed<n>(x); }
+
+template<size_t n, word d, class T>
+inline Fixed<n> operator+(BigUnsigned<d, T> x, const Fixed<n>& a) { return a + Fixed<n>(x); }
+
+template<size_t n, word d, class T>
+inline Fixed<n> operator-(const Fixed<n>& a, BigUnsigned<d, T> x) { return a - Fixed<n>(x); }
+
+template<size_t n, word d, class T>
+inline Fixed<n> operator-(BigUnsigned<d, T> x, const Fixed<n>& a) { return Fixed<n>(x) - a; }
+
+// quotient and residue by a static divisor through InvariantDivisor
+template<size_t n, word d, class T>
+inline Fixed<n> operator/(const Fixed<n>& a, BigUnsigned<d, T>) {
+    using D = InvariantDivisor<BigUnsigned<d, T>>;
+    static_assert(D::length <= n, "divisor longer than the dividend");
+    Fixed<n> q;
+    word r[D::length];
+    D::divide(q.words, r, a.words, n);
+    return q;
+}
+
+template<size_t n, word d, class T>
+inline Fixed<n> operator%(const Fixed<n>& a, BigUnsigned<d, T>) {
+    using D = InvariantDivisor<BigUnsigned<d, T>>;
+    static_assert(D::length <= n, "divisor longer than the dividend");
+    Fixed<n> q, r;
+    D::divide(q.words, r.words, a.words, n);
+    return r;
+}
+
+template<size_t n, word d, class T>
+inline bool operator==(const Fixed<n>& a, BigUnsigned<d, T> x) { return a == Fixed<n>(x); }
+template<size_t n, word d, class T>
+inline bool operator!=(const Fixed<n>& a, BigUnsigned<d, T> x) { return a != Fixed<n>(x); }
+template<size_t n, word d, class T>
+inline bool operator< (const Fixed<n>& a, BigUnsigned<d, T> x) { return a <  Fixed<n>(x); }
+template<size_t n, word d, class T>
+inline bool operator<=(const Fixed<n>& a, BigUnsigned<d, T> x) { return a <= Fixed<n>(x); }
+template<size_t n, word d, class T>
+inline bool operator> (const Fixed<n>& a, BigUnsigned<d, T> x) { return a >  Fixed<n>(x); }
+template<size_t n, word d, class T>
+inline bool operator>=(const Fixed<n>& a, BigUnsigned<d, T> x) { return a >= Fixed<n>(x); }
+
+///////////////////////////////////////////////////////////////////////////
+//////////////////////////// decimal conversion ///////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// Decimal strings of runtime numbers of any length, by divide and conquer:
+// a number below 10 ** (chunk_digits << (i + 1)) is split by
+// 10 ** (chunk_digits << i) into two halves of that many digits each, down
+// to numbers of a few words, which go chunk by chunk like DecimalChunks.
+// The first STATIC_BIGNUM_DECIMAL_LEVELS powers come from a SquareTable and
+// the rest are squared at runtime. Quotients are Burnikel and Ziegler's
+// recursive division and products are Karatsuba's, so that n words take
+// O(n ** 1.58) word operations either way instead of O(n ** 2). Nothing is
+// allocated: the caller passes decimal_scratch_length(n) words of scratch,
+// which Fixed numbers take from the stack.
+
+#ifndef STATIC_BIGNUM_DECIMAL_LEVELS
+#define STATIC_BIGNUM_DECIMAL_LEVELS 7
+#endif
+
+// runtime products and quotients of fewer words are schoolbook
+#ifndef STATIC_BIGNUM_RUNTIME_KARATSUBA_THRESHOLD
+#define STATIC_BIGNUM_RUNTIME_KARATSUBA_THRESHOLD 24
+#endif
+
+// numbers of fewer words are converted chunk by chunk
+#ifndef STATIC_BIGNUM_DECIMAL_THRESHOLD
+#define STATIC_BIGNUM_DECIMAL_THRESHOLD 32
+#endif
+
+// n without the leading zero words of a
+inline size_t significant_words(const word* a, size_t n) {
+    while (n > 0 && a[n - 1] == 0)
+        --n;
+    return n;
+}
+
+// r = a + b for n-word arrays, returns the carry
+inline word add_words(word* r, const word* a, const word* b, size_t n) {
+    word carry = 0;
+    for (size_t i = 0; i < n; ++i)
+        r[i] = add_with_carry(a[i], b[i], carry);
+    return carry;
+}
+
+// r += carry and r -= borrow for an n-word r, returning what is left over
+inline word increment_words(word* r, size_t n, word carry) {
+    for (size_t i = 0; i < n && carry != 0; ++i)
+        r[i] = add_with_carry(r[i], 0, carry);
+    return carry;
+}
+
+inline word decrement_words(word* r, size_t n, word borrow) {
+    for (size_t i = 0; i < n && borrow != 0; ++i)
+        r[i] = subtract_with_borrow(r[i], 0, borrow);
+    return borrow;
+}
+
+// -1, 0 or 1 as a is less than, equal to or greater than b, both of n words
+inline int compare_words(const word* a, const word* b, size_t n) {
+    for (size_t i = n; i-- > 0;)
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    return 0;
+}
+
+// r = |a - b| for a of n words and b of m <= n words, true if a < b
+inline bool difference_words(word* r, const word* a, size_t n, const word* b, size_t m) {
+    word borrow = 0;
+    for (size_t i = 0; i < n; ++i)
+        r[i] = subtract_with_borrow(a[i], i < m ? b[i] : 0, borrow);
+    if (borrow == 0)
+        return false;
+    word carry = 1;
+    for (size_t i = 0; i < n; ++i)
+        r[i] = add_with_carry(~r[i], 0, carry);
+    return true;
+}
+
+// r = a << s and r = a >> s for n-word arrays and s < word_bits; the left
+// shift returns the bits shifted out and both may work in place
+inline word shift_left_words(word* r, const word* a, size_t n, int s) {
+    if (s == 0) {
+        std::memmove(r, a, n * sizeof(word));
+        return 0;
+    }
+    word out = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const word x = a[i];
+        r[i] = (x << s) | out;
+        out = x >> (word_bits - s);
+    }
+    return out;
+}
+
+inline void shift_right_words(word* r, const word* a, size_t n, int s) {
+    if (s == 0) {
+        std::memmove(r, a, n * sizeof(word));
+        return;
+    }
+    for (size_t i = 0; i < n; ++i)
+        r[i] = (a[i] >> s) | (i + 1 < n ? a[i + 1] << (word_bits - s) : 0);
+}
+
+constexpr size_t karatsuba_scratch_length(size_t n) {
+    return n < STATIC_BIGNUM_RUNTIME_KARATSUBA_THRESHOLD ? 0
+        : 4 * (n - n / 2) + max_of(karatsuba_scratch_length(n - n / 2), 2 * (n - n / 2) + 1);
+}
+
+// r = a * b for a and b of n words, r has 2n words and must not alias them;
+// t is scratch of karatsuba_scratch_length(n) words
+inline void karatsuba_multiply_words(word* r, const word* a, const word* b, size_t n, word* t) {
+    if (n < STATIC_BIGNUM_RUNTIME_KARATSUBA_THRESHOLD) {
+        multiply_words(r, a, n, b, n);
+        return;
+    }
+    // a = a0 + a1 * P ** h and b = b0 + b1 * P ** h, a1 and b1 of l >= h words
+    const size_t h = n / 2, l = n - h;
+    karatsuba_multiply_words(r, a, b, h, t);
+    karatsuba_multiply_words(r + 2 * h, a + h, b + h, l, t);
+    word* da = t;
+    word* db = t + l;
+    word* m = t + 2 * l;
+    word* mid = t + 4 * l;
+    const bool negative = difference_words(da, a + h, l, a, h) != difference_words(db, b + h, l, b, h);
+    karatsuba_multiply_words(m, da, db, l, t + 4 * l);
+    // a0 * b1 + a1 * b0 = a0 * b0 + a1 * b1 - (a1 - a0) * (b1 - b0)
+    std::memcpy(mid, r, 2 * h * sizeof(word));
+    std::memset(mid + 2 * h, 0, (2 * l - 2 * h) * sizeof(word));
+    mid[2 * l] = add_words(mid, mid, r + 2 * h, 2 * l);
+    if (negative)
+        mid[2 * l] += add_words(mid, mid, m, 2 * l);
+    else
+        mid[2 * l] -= subtract_words(mid, mid, m, 2 * l);
+    increment_words(r + h + 2 * l + 1, 2 * n - h - 2 * l - 1, add_words(r + h, r + h, mid, 2 * l + 1));
+}
+
+constexpr size_t long_multiply_scratch_length(size_t m) {
+    return 3 * m + karatsuba_scratch_length(m);
+}
+
+// r = a * b for a of n words and b of m <= n words, r has n + m words and
+// must not alias them; t is scratch of long_multiply_scratch_length(m) words
+inline void long_multiply_words(word* r, const word* a, size_t n, const word* b, size_t m, word* t) {
+    if (m < STATIC_BIGNUM_RUNTIME_KARATSUBA_THRESHOLD) {
+        multiply_words(r, a, n, b, m);
+        return;
+    }
+    // m by m blocks of a, the last one padded with zero words
+    word* p = t;
+    word* block = t + 2 * m;
+    std::memset(r, 0, (n + m) * sizeof(word));
+    for (size_t i = 0; i < n; i += m) {
+        const size_t k = n - i < m ? n - i : m;
+        std::memcpy(block, a + i, k * sizeof(word));
+        std::memset(block + k, 0, (m - k) * sizeof(word));
+        karatsuba_multiply_words(p, block, b, m, t + 3 * m);
+        const word carry = add_words(r + i, r + i, p, k + m);
+        increment_words(r + i + k + m, n - i - k, carry);
+    }
+}
+
+// q = u / d and u = u % d for a normalized d (top bit set) of dn words and
+// u of un >= dn words with its top dn words below d, by Knuth's algorithm D:
+// q has un - dn words and the residue is left in the low dn words of u, the
+// rest being cleared
+inline void schoolbook_divide_words(word* q, word* u, size_t un, const word* d, size_t dn) {
+    const word d1 = d[dn - 1], d0 = dn > 1 ? d[dn - 2] : 0;
+    const word v = div_word(~d1, word_max, d1);
+    for (size_t j = un - dn; j-- > 0;) {
+        word* w = u + j;
+        // estimate from the top two words of w, then the second word of d
+        // leaves it at most one too large
+        word estimate, rest;
+        bool overflow = false;
+        if (w[dn] == d1) {
+            estimate = word_max;
+            rest = w[dn - 1] + d1;
+            overflow = rest < d1;
+        } else {
+            estimate = divide_preinverted(w[dn], w[dn - 1], d1, v, rest);
+        }
+        while (dn > 1 && !overflow) {
+            const word high = mul_hi(estimate, d0), low = mul_lo(estimate, d0);
+            if (high < rest || (high == rest && low <= w[dn - 2]))
+                break;
+            --estimate;
+            rest += d1;
+            overflow = rest < d1;
+        }
+        word carry = 0, borrow = 0;
+        for (size_t i = 0; i < dn; ++i)
+            w[i] = subtract_with_borrow(w[i], mul_add(estimate, d[i], 0, carry, carry), borrow);
+        w[dn] = subtract_with_borrow(w[dn], carry, borrow);
+        if (borrow != 0) {
+            --estimate;
+            w[dn] += add_words(w, w, d, dn);
+        }
+        q[j] = estimate;
+    }
+}
+
+constexpr size_t division_scratch_length(size_t n) {
+    return n % 2 == 1 || n < STATIC_BIGNUM_RUNTIME_KARATSUBA_THRESHOLD ? 0
+        : max_of(division_scratch_length(n / 2), n + karatsuba_scratch_length(n / 2));
+}
+
+// the least m >= n that halves evenly down to below the threshold
+constexpr size_t division_length(size_t n, size_t unit = 1) {
+    return n < STATIC_BIGNUM_RUNTIME_KARATSUBA_THRESHOLD ? n * unit : division_length((n + 1) / 2, 2 * unit);
+}
+
+inline void divide_words_3by2(word* q, word* a, const word* b, size_t h, word* t);
+
+// q = a / b and a = a % b for a normalized b of n words and a of 2n words
+// below b * P ** n, by Burnikel and Ziegler's recursive division: q has n
+// words and the residue is left in the low n words of a, the rest being
+// cleared; t is scratch of division_scratch_length(n) words. n should be a
+// division_length, other lengths fall back to schoolbook division sooner.
+inline void divide_words_2by1(word* q, word* a, const word* b, size_t n, word* t) {
+    if (n % 2 == 1 || n < STATIC_BIGNUM_RUNTIME_KARATSUBA_THRESHOLD) {
+        schoolbook_divide_words(q, a, 2 * n, b, n);
+        return;
+    }
+    const size_t h = n / 2;
+    divide_words_3by2(q + h, a + h, b, h, t);
+    divide_words_3by2(q, a, b, h, t);
+}
+
+// the same for a of 3h words below b * P ** h and b of 2h words
+inline void divide_words_3by2(word* q, word* a, const word* b, size_t h, word* t) {
+    // the top 2h words of a by the top h words of b, at most two too large
+    if (compare_words(a + 2 * h, b + h, h) < 0) {
+        divide_words_2by1(q, a + h, b + h, h, t);
+    } else {
+        // equal top words: q = P ** h - 1 leaves a[h, 3h) + b[h, 2h)
+        for (size_t i = 0; i < h; ++i)
+            q[i] = word_max;
+        std::memset(a + 2 * h, 0, h * sizeof(word));
+        a[2 * h] = add_words(a + h, a + h, b + h, h);
+    }
+    // a -= q * b[0, h), adding b back while it is negative
+    word* p = t;
+    karatsuba_multiply_words(p, q, b, h, t + 2 * h);
+    a[2 * h] -= subtract_words(a, a, p, 2 * h);
+    while (a[2 * h] != 0) {
+        decrement_words(q, h, 1);
+        a[2 * h] += add_words(a, a, b, 2 * h);
+    }
+}
+
+// digits of numbers below P ** n and words of numbers below 10 ** digits at
+// most; log10(2) < 0.30103 and log2(10) < 3.3220
+constexpr size_t decimal_digits_bound(size_t n) {
+    return n * word_bits * 30103 / 100000 + 1;
+}
+
+constexpr size_t decimal_words_bound(size_t digits) {
+    return digits * 33220 / 10000 / word_bits + 1;
+}
+
+// the least level i with up to chunk_digits << (i + 1) digits
+constexpr size_t decimal_level(size_t digits, size_t i = 0) {
+    return (chunk_digits << (i + 1)) >= digits ? i : decimal_level(digits, i + 1);
+}
+
+// numbers of levels up to this one, of about STATIC_BIGNUM_DECIMAL_THRESHOLD
+// words, go chunk by chunk
+constexpr size_t decimal_base_level = decimal_level(decimal_digits_bound(STATIC_BIGNUM_DECIMAL_THRESHOLD));
+
+// words of 10 ** (chunk_digits << i), and of its padded divisor, at most
+constexpr size_t decimal_power_words(size_t i) {
+    return decimal_words_bound(chunk_digits << i);
+}
+
+constexpr size_t decimal_divisor_words(size_t i) {
+    return division_length(decimal_power_words(i));
+}
+
+// scratch of the powers up to level top: squares and padded divisors
+constexpr size_t decimal_powers_length(size_t top, size_t levels, size_t i = 0) {
+    return i > top ? 0 : (i >= levels ? 2 * decimal_power_words(i - 1) : 0)
+        + (i > decimal_base_level ? decimal_divisor_words(i) : 0) + decimal_powers_length(top, levels, i + 1);
+}
+
+// scratch of the recursion from level i down, writing and reading
+constexpr size_t decimal_write_length(size_t i) {
+    return i <= decimal_base_level ? 0 : 3 * decimal_divisor_words(i)
+        + max_of(division_scratch_length(decimal_divisor_words(i)), decimal_write_length(i - 1));
+}
+
+constexpr size_t decimal_read_length(size_t i) {
+    return i <= decimal_base_level ? 0 : 4 * decimal_power_words(i - 1)
+        + max_of(long_multiply_scratch_length(decimal_power_words(i)), decimal_read_length(i - 1));
+}
+
+constexpr size_t decimal_level_scratch_length(size_t top, size_t levels) {
+    return decimal_powers_length(top, levels) + max_of(
+        top >= levels ? karatsuba_scratch_length(decimal_power_words(top - 1)) : 0,
+        decimal_write_length(top), 2 * decimal_power_words(top) + decimal_read_length(top));
+}
+
+// words of scratch that to_decimal and from_decimal need for n words
+constexpr size_t decimal_scratch_length(size_t n, size_t levels = STATIC_BIGNUM_DECIMAL_LEVELS) {
+    return decimal_level_scratch_length(decimal_level(decimal_digits_bound(n)), levels);
+}
+
+// characters to_decimal writes for n words at most, the terminating NUL included
+constexpr size_t decimal_length_bound(size_t n) {
+    return decimal_digits_bound(n) + 1;
+}
+
+// 10 ** (chunk_digits << i) as it is and as a divisor, shifted left by
+// shift bits and padded with zero words to divisor_length words
+struct DecimalPower {
+    const word* value;
+    size_t length;
+    const word* divisor;
+    size_t divisor_length;
+    int shift;
+};
+
+// the powers of levels up to top, returning the scratch past them
+template<size_t levels>
+inline word* decimal_powers(DecimalPower* powers, size_t top, word* t) {
+    static_assert(levels > 0, "STATIC_BIGNUM_DECIMAL_LEVELS must be positive");
+    using Table = SquareTable<BigUnsigned<power_of_10(chunk_digits), Zero>, levels>;
+    for (size_t i = 0; i <= top; ++i) {
+        DecimalPower& p = powers[i];
+        if (i < levels) {
+            p.value = Table::value[i];
+            p.length = significant_words(p.value, Table::limbs);
+        } else {
+            const DecimalPower& root = powers[i - 1];
+            word* square = t;
+            t += 2 * decimal_power_words(i - 1);
+            karatsuba_multiply_words(square, root.value, root.value, root.length, t);
+            p.value = square;
+            p.length = significant_words(square, 2 * root.length);
+        }
+        if (i > decimal_base_level) {
+            word* divisor = t;
+            p.divisor = divisor;
+            p.divisor_length = decimal_divisor_words(i);
+            p.shift = leading_zeros(p.value[p.length - 1]);
+            t += p.divisor_length;
+            const size_t padding = p.divisor_length - p.length;
+            std::memset(divisor, 0, padding * sizeof(word));
+            shift_left_words(divisor + padding, p.value, p.length, p.shift);
+        }
+    }
+    return t;
+}
+
+// x as chunk_digits digits, or without leading zeros unless pad
+inline char* write_chunk(char* out, word x, bool pad) {
+    char digits[chunk_digits];
+    size_t i = chunk_digits;
+    do {
+        digits[--i] = static_cast<char>('0' + static_cast<int>(x % 10));
+        x /= 10;
+    } while (pad ? i > 0 : x != 0);
+    std::memcpy(out, digits + i, chunk_digits - i);
+    return out + (chunk_digits - i);
+}
+
+// x of n words below 10 ** (chunk_digits << (level + 1)), as exactly that
+// many digits if pad and without leading zeros otherwise; returns the end
+inline char* write_decimal(char* out, const word* x, size_t n, size_t level, bool pad,
+                           const DecimalPower* powers, word* t) {
+    n = significant_words(x, n);
+    if (level <= decimal_base_level) {
+        word y[decimal_power_words(decimal_base_level + 1)];
+        word chunks[size_t(2) << decimal_base_level];
+        std::memcpy(y, x, n * sizeof(word));
+        size_t count = 0;
+        for (; n > 0; n = significant_words(y, n))
+            WordInvariantDivisor<power_of_10(chunk_digits)>::divide(y, chunks + count++, y, n);
+        for (size_t i = count; pad && i < (size_t(2) << level); ++i)
+            out = write_chunk(out, 0, true);
+        for (size_t i = count; i-- > 0;)
+            out = write_chunk(out, chunks[i], pad || i + 1 < count);
+        return out;
+    }
+    const DecimalPower& p = powers[level];
+    if (n < p.length) {
+        // the high half is zero
+        for (size_t i = 0; pad && i < (size_t(1) << level); ++i)
+            out = write_chunk(out, 0, true);
+        return write_decimal(out, x, n, level - 1, pad, powers, t);
+    }
+    // a = x * 2 ** shift * P ** padding is below divisor * P ** m, and a
+    // short quotient is left to schoolbook division
+    const size_t m = p.divisor_length, padding = m - p.length;
+    const size_t length = padding + n + 2 < 2 * m ? padding + n + 2 : 2 * m;
+    word* a = t;
+    word* q = t + 2 * m;
+    std::memset(a, 0, 2 * m * sizeof(word));
+    std::memset(q, 0, m * sizeof(word));
+    const word top = shift_left_words(a + padding, x, n, p.shift);
+    if (padding + n < 2 * m)
+        a[padding + n] = top;
+    if (length - m < STATIC_BIGNUM_RUNTIME_KARATSUBA_THRESHOLD)
+        schoolbook_divide_words(q, a, length, p.divisor, m);
+    else
+        divide_words_2by1(q, a, p.divisor, m, t + 3 * m);
+    word* r = a + padding;
+    shift_right_words(r, r, p.length, p.shift);
+    const bool high = significant_words(q, m) != 0;
+    if (high || pad)
+        out = write_decimal(out, q, m, level - 1, pad, powers, t + 3 * m);
+    return write_decimal(out, r, p.length, level - 1, high || pad, powers, t + 3 * m);
+}
+
+// writes the decimal digits of a of n words and a NUL to out, which has
+// room for decimal_length_bound(n) characters, and returns their number;
+// t is scratch of decimal_scratch_length(n, levels) words
+template<size_t levels = STATIC_BIGNUM_DECIMAL_LEVELS>
+inline size_t to_decimal(char* out, const word* a, size_t n, word* t) {
+    n = significant_words(a, n);
+    const size_t level = decimal_level(decimal_digits_bound(n));
+    DecimalPower powers[8 * sizeof(size_t)];
+    if (level > decimal_base_level)
+        t = decimal_powers<levels>(powers, level, t);
+    char* end = n == 0 ? write_chunk(out, 0, false) : write_decimal(out, a, n, level, false, powers, t);
+    *end = '\0';
+    return static_cast<size_t>(end - out);
+}
+
+// the digits s[0, length), length <= chunk_digits << (level + 1), into r;
+// returns the words of r
+inline size_t read_decimal(word* r, const char* s, size_t length, size_t level,
+                           const DecimalPower* powers, word* t) {
+    if (level <= decimal_base_level) {
+        size_t n = 0;
+        for (size_t i = 0; i < length;) {
+            // the first chunk takes what is left over
+            const size_t end = i + (length - i - 1) % chunk_digits + 1;
+            word chunk = 0, scale = 1;
+            for (; i < end; ++i) {
+                chunk = chunk * 10 + static_cast<word>(s[i] - '0');
+                scale *= 10;
+            }
+            for (size_t j = 0; j < n; ++j)
+                r[j] = mul_add(r[j], scale, chunk, 0, chunk);
+            if (chunk != 0)
+                r[n++] = chunk;
+        }
+        return n;
+    }
+    const size_t half = chunk_digits << level;
+    if (length <= half)
+        return read_decimal(r, s, length, level - 1, powers, t);
+    // r = high * 10 ** half + low
+    const DecimalPower& p = powers[level];
+    const size_t capacity = 2 * decimal_power_words(level - 1);
+    word* high = t;
+    word* low = t + capacity;
+    const size_t hn = read_decimal(high, s, length - half, level - 1, powers, t + 2 * capacity);
+    const size_t ln = read_decimal(low, s + length - half, half, level - 1, powers, t + 2 * capacity);
+    if (hn == 0) {
+        std::memcpy(r, low, ln * sizeof(word));
+        return ln;
+    }
+    long_multiply_words(r, p.value, p.length, high, hn, t + 2 * capacity);
+    const size_t n = p.length + hn;
+    increment_words(r + ln, n - ln, add_words(r, r, low, ln));
+    return significant_words(r, n);
+}
+
+// reads the decimal digits s[0, length) into r of n words and returns true,
+// or returns false and leaves r alone if there is anything but digits or
+// the number does not fit; t is scratch of decimal_scratch_length(n, levels)
+// words
+template<size_t levels = STATIC_BIGNUM_DECIMAL_LEVELS>
+inline bool from_decimal(word* r, size_t n, const char* s, size_t length, word* t) {
+    if (length == 0)
+        return false;
+    for (size_t i = 0; i < length; ++i)
+        if (s[i] < '0' || s[i] > '9')
+            return false;
+    for (; length > 1 && *s == '0'; --length)
+        ++s;
+    if (length > decimal_digits_bound(n))
+        return false;
+    const size_t level = decimal_level(length);
+    DecimalPower powers[8 * sizeof(size_t)];
+    if (level > decimal_base_level)
+        t = decimal_powers<levels>(powers, level, t);
+    word* x = t;
+    const size_t m = read_decimal(x, s, length, level, powers, t + 2 * decimal_power_words(level));
+    if (m > n)
+        return false;
+    std::memcpy(r, x, m * sizeof(word));
+    std::memset(r + m, 0, (n - m) * sizeof(word));
+    return true;
+}
+
+// the same for Fixed numbers, with the scratch on the stack
+template<size_t n>
+inline size_t to_decimal(char* out, const Fixed<n>& a) {
+    word t[decimal_scratch_length(n) + 1];
+    return to_decimal(out, a.words, n, t);
+}
+
+template<size_t n>
+inline bool from_decimal(Fixed<n>& r, const char* s, size_t length) {
+    word t[decimal_scratch_length(n) + 1];
+    return from_decimal(r.words, n, s, length, t);
+}
+
+///////////////////////////////////////////////////////////////////////////
+///////////////////////////////// batches /////////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// A batch of count numbers of n words is stored as a structure of arrays:
+// word i of element k is p[i * count + k]. Kernels run a block of elements
+// at a time, word by word, and every step is the same for all elements
+// of the block, so the compiler turns them into vector instructions. On
+// x86 with GCC or Clang each kernel is also compiled for AVX2 and AVX-512,
+// and the best one the CPU supports is chosen at runtime.
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) \
+    && !defined(STATIC_BIGNUM_NO_BATCH_DISPATCH)
+#define STATIC_BIGNUM_BATCH_DISPATCH
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STATIC_BIGNUM_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define STATIC_BIGNUM_ALWAYS_INLINE __forceinline
+#else
+#define STATIC_BIGNUM_ALWAYS_INLINE inline
+#endif
+
+enum class BatchTarget { portable, avx2, avx512 };
+
+inline BatchTarget detect_batch_target(void) {
+#ifdef STATIC_BIGNUM_BATCH_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return BatchTarget::avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return BatchTarget::avx2;
+#endif
+    return BatchTarget::portable;
+}
+
+// the instruction set of batch kernels, detected on first use; it may be
+// lowered, e.g. to compare kernels, but not raised above what the CPU has
+inline BatchTarget& batch_target(void) {
+    static BatchTarget target = detect_batch_target();
+    return target;
+}
+
+// elements per block of vectorized kernels; every step of a kernel is a
+// loop over the elements of a block, with a constant trip count the
+// compiler vectorizes. Kernels whose products stay scalar run on blocks of
+// one element instead, which keeps its words in registers.
+static const size_t batch_block = 16;
+
+// one word of every element of a block of w elements
+template<size_t w>
+struct Lanes {
+    word v[w];
+};
+
+// operands of lane operations: lanes, or a word shared by all lanes
+template<size_t w>
+STATIC_BIGNUM_ALWAYS_INLINE word lane(const Lanes<w>& x, size_t k) { return x.v[k]; }
+STATIC_BIGNUM_ALWAYS_INLINE word lane(word x, size_t) { return x; }
+
+// the loop over the lanes of a block; kept rolled, so that it is
+// vectorized rather than unrolled
+#if defined(__GNUC__) && __GNUC__ >= 8
+#define STATIC_BIGNUM_LANES _Pragma("GCC unroll 1")
+#else
+#define STATIC_BIGNUM_LANES
+#endif
+
+// r = a + b + carry and r = a - b - borrow with plain comparisons, which
+// vectorize where carry flags do not
+template<size_t w, class A, class B>
+STATIC_BIGNUM_ALWAYS_INLINE void lanes_add(Lanes<w>& r, const A& a, const B& b, Lanes<w>& carry) {
+    STATIC_BIGNUM_LANES
+    for (size_t k = 0; k < w; ++k) {
+        const word x = lane(a, k), partial = x + lane(b, k), sum = partial + carry.v[k];
+        carry.v[k] = (partial < x ? 1 : 0) | (sum < partial ? 1 : 0);
+        r.v[k] = sum;
+    }
+}
+
+template<size_t w, class A, class B>
+STATIC_BIGNUM_ALWAYS_INLINE void lanes_subtract(Lanes<w>& r, const A& a, const B& b, Lanes<w>& borrow) {
+    STATIC_BIGNUM_LANES
+    for (size_t k = 0; k < w; ++k) {
+        const word x = lane(a, k), y = lane(b, k), partial = x - y, difference = partial - borrow.v[k];
+        borrow.v[k] = (x < y ? 1 : 0) | (partial < borrow.v[k] ? 1 : 0);
+        r.v[k] = difference;
+    }
+}
+
+// a * b + c + d as mul_add computes it, or with std::true_type from four
+// products of half words, which vector units multiply where they lack a
+// full one
+STATIC_BIGNUM_ALWAYS_INLINE word lane_mul_add(word a, word b, word c, word d, word& high, std::false_type) {
+    return mul_add(a, b, c, d, high);
+}
+
+STATIC_BIGNUM_ALWAYS_INLINE word lane_mul_add(word a, word b, word c, word d, word& high, std::true_type) {
+    const size_t half = word_bits / 2;
+    const word mask = word_max >> half;
+    const word a0 = a & mask, a1 = a >> half, b0 = b & mask, b1 = b >> half;
+    const word p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const word middle = (p00 >> half) + (p01 & mask) + (p10 & mask);
+    word low = (p00 & mask) | (middle << half);
+    word h = p11 + (p01 >> half) + (p10 >> half) + (middle >> half);
+    low += c;
+    h += low < c ? 1 : 0;
+    low += d;
+    h += low < d ? 1 : 0;
+    high = h;
+    return low;
+}
+
+// r = low word of a * b + c + carry, carry = its high word
+template<size_t w, class A, class B, class Split>
+STATIC_BIGNUM_ALWAYS_INLINE void lanes_mul_add(Lanes<w>& r, const A& a, const B& b, const Lanes<w>& c, Lanes<w>& carry, Split split) {
+    STATIC_BIGNUM_LANES
+    for (size_t k = 0; k < w; ++k)
+        r.v[k] = lane_mul_add(lane(a, k), lane(b, k), c.v[k], carry.v[k], carry.v[k], split);
+}
+
+// r = mask ? a : b for masks of all ones or zeros
+template<size_t w>
+STATIC_BIGNUM_ALWAYS_INLINE void lanes_select(Lanes<w>& r, const Lanes<w>& mask, const Lanes<w>& a, const Lanes<w>& b) {
+    STATIC_BIGNUM_LANES
+    for (size_t k = 0; k < w; ++k)
+        r.v[k] = (a.v[k] & mask.v[k]) | (b.v[k] & ~mask.v[k]);
+}
+
+template<size_t w>
+STATIC_BIGNUM_ALWAYS_INLINE void lanes_fill(Lanes<w>& r, word x) {
+    STATIC_BIGNUM_LANES
+    for (size_t k = 0; k < w; ++k)
+        r.v[k] = x;
+}
+
+// word i of the second operand of a kernel: lanes of a batch, or a word
+// of a static number, which is a constant in the kernel
+template<class X>
+struct BatchOperand {
+    static const bool batch = false;
+    template<size_t n, size_t w>
+    static STATIC_BIGNUM_ALWAYS_INLINE word get(const Lanes<w>* b, size_t i) {
+        static_assert(Optimize<X>::Result::length <= n, "static operand longer than the batch numbers");
+        return PaddedWordArray<X, n>::value[i];
+    }
+};
+
+template<>
+struct BatchOperand<void> {
+    static const bool batch = true;
+    template<size_t n, size_t w>
+    static STATIC_BIGNUM_ALWAYS_INLINE const Lanes<w>& get(const Lanes<w>* b, size_t i) {
+        return b[i];
+    }
+};
+
+// r = a + b and r = a - b modulo P ** n, b from a batch for X = void
+template<size_t n, class X>
+struct BatchAdd {
+    using Operand = BatchOperand<X>;
+    static const bool binary = Operand::batch;
+    using Out = word;
+    static const size_t length = n, outputs = n;
+    static const bool multiplies = false;
+
+    template<size_t w, class Split>
+    static STATIC_BIGNUM_ALWAYS_INLINE void block(Lanes<w>* r, const Lanes<w>* a, const Lanes<w>* b, Split) {
+        Lanes<w> carry;
+        lanes_fill(carry, 0);
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < n; ++i)
+            lanes_add(r[i], a[i], Operand::template get<n>(b, i), carry);
+    }
+    static STATIC_BIGNUM_ALWAYS_INLINE Out output(word z) { return z; }
+};
+
+template<size_t n, class X>
+struct BatchSubtract {
+    using Operand = BatchOperand<X>;
+    static const bool binary = Operand::batch;
+    using Out = word;
+    static const size_t length = n, outputs = n;
+    static const bool multiplies = false;
+
+    template<size_t w, class Split>
+    static STATIC_BIGNUM_ALWAYS_INLINE void block(Lanes<w>* r, const Lanes<w>* a, const Lanes<w>* b, Split) {
+        Lanes<w> borrow;
+        lanes_fill(borrow, 0);
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < n; ++i)
+            lanes_subtract(r[i], a[i], Operand::template get<n>(b, i), borrow);
+    }
+    static STATIC_BIGNUM_ALWAYS_INLINE Out output(word z) { return z; }
+};
+
+// -1, 0 or 1 as a is less than, equal to or greater than b
+template<size_t n, class X>
+struct BatchCompare {
+    using Operand = BatchOperand<X>;
+    static const bool binary = Operand::batch;
+    using Out = int8_t;
+    static const size_t length = n, outputs = 1;
+    static const bool multiplies = false;
+
+    template<size_t w, class Split>
+    static STATIC_BIGNUM_ALWAYS_INLINE void block(Lanes<w>* r, const Lanes<w>* a, const Lanes<w>* b, Split) {
+        // the most significant difference wins, word_max stands for -1
+        lanes_fill(r[0], 0);
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < n; ++i) {
+            const auto& y = Operand::template get<n>(b, i);
+            STATIC_BIGNUM_LANES
+            for (size_t k = 0; k < w; ++k)
+                r[0].v[k] = a[i].v[k] > lane(y, k) ? 1 : a[i].v[k] < lane(y, k) ? word_max : r[0].v[k];
+        }
+    }
+    static STATIC_BIGNUM_ALWAYS_INLINE Out output(word z) {
+        return static_cast<Out>(z == 0 ? 0 : z == 1 ? 1 : -1);
+    }
+};
+
+// r = t - m where that does not underflow, t otherwise, for t and m of
+// size words
+template<size_t size, size_t w>
+STATIC_BIGNUM_ALWAYS_INLINE void lanes_subtract_if_not_less(Lanes<w>* t, const word* m) {
+    Lanes<w> d[size], borrow;
+    lanes_fill(borrow, 0);
+    STATIC_BIGNUM_UNROLL
+    for (size_t i = 0; i < size; ++i)
+        lanes_subtract(d[i], t[i], m[i], borrow);
+    // borrow is 1 exactly where t < m, and its negation a mask
+    STATIC_BIGNUM_LANES
+    for (size_t k = 0; k < w; ++k)
+        borrow.v[k] = 0 - borrow.v[k];
+    STATIC_BIGNUM_UNROLL
+    for (size_t i = 0; i < size; ++i)
+        lanes_select(t[i], borrow, t[i], d[i]);
+}
+
+// r = a mod M for a of n words and M of k words by Barrett's method with
+// mu = P ** n / M: for s = n - k + 1, (a / P ** (k - 1)) * mu / P ** s is
+// at most 2 less than a / M
+template<size_t n, class M>
+struct BatchReduce {
+    using Modulus = typename Optimize<M>::Result;
+    static const size_t k = Modulus::length;
+    static_assert(k > 0, "division by zero");
+    static_assert(k <= n, "modulus longer than the batch numbers");
+    static const size_t s = n - k + 1;
+    // mu <= P ** s, with equality only for M = P ** (k - 1)
+    using Mu = typename Division<typename ShiftLeft<One, word_bits * n>::Result, Modulus>::Quotient;
+    static const bool binary = false;
+    using Out = word;
+    static const size_t length = n, outputs = k;
+    static const bool multiplies = true;
+
+    template<size_t w, class Split>
+    static STATIC_BIGNUM_ALWAYS_INLINE void block(Lanes<w>* r, const Lanes<w>* a, const Lanes<w>* b, Split split) {
+        const word* mu = PaddedWordArray<Mu, s + 1>::value;
+        const word* m = PaddedWordArray<Modulus, k + 1>::value;
+        // q = words s to 2s - 1 of (a / P ** (k - 1)) * mu
+        Lanes<w> p[2 * s + 1];
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < s; ++i)
+            lanes_fill(p[i], 0);
+        STATIC_BIGNUM_UNROLL
+        for (size_t j = 0; j <= s; ++j) {
+            Lanes<w>& carry = p[s + j];
+            lanes_fill(carry, 0);
+            STATIC_BIGNUM_UNROLL
+            for (size_t i = 0; i < s; ++i)
+                lanes_mul_add(p[i + j], a[k - 1 + i], mu[j], p[i + j], carry, split);
+        }
+        const Lanes<w>* q = p + s;
+        // a - q * M modulo P ** (k + 1), which is less than 3 * M
+        Lanes<w> t[k + 1];
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i <= k; ++i)
+            lanes_fill(t[i], 0);
+        STATIC_BIGNUM_UNROLL
+        for (size_t j = 0; j < k; ++j) {
+            // words of q that reach below P ** (k + 1)
+            const size_t row = k + 1 - j < s ? k + 1 - j : s;
+            Lanes<w> carry;
+            lanes_fill(carry, 0);
+            STATIC_BIGNUM_UNROLL
+            for (size_t i = 0; i < row; ++i)
+                lanes_mul_add(t[i + j], q[i], m[j], t[i + j], carry, split);
+            if (j + s <= k)
+                t[j + s] = carry;
+        }
+        Lanes<w> borrow;
+        lanes_fill(borrow, 0);
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < k; ++i)
+            lanes_subtract(t[i], a[i], t[i], borrow);
+        if (k < n)
+            lanes_subtract(t[k], a[k], t[k], borrow);
+        else
+            lanes_subtract(t[k], word(0), t[k], borrow);
+        lanes_subtract_if_not_less<k + 1>(t, m);
+        lanes_subtract_if_not_less<k + 1>(t, m);
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < k; ++i)
+            r[i] = t[i];
+    }
+    static STATIC_BIGNUM_ALWAYS_INLINE Out output(word z) { return z; }
+};
+
+// r = a * b / R mod N as Montgomery<N>::mul computes it, b from a batch
+// for X = void
+template<class N, class X>
+struct BatchMontgomery {
+    using Modulus = typename Montgomery<N>::Modulus;
+    static const size_t n = Modulus::length;
+    using Operand = BatchOperand<X>;
+    static const bool binary = Operand::batch;
+    using Out = word;
+    static const size_t length = n, outputs = n;
+    static const bool multiplies = true;
+
+    template<size_t w, class Split>
+    static STATIC_BIGNUM_ALWAYS_INLINE void block(Lanes<w>* r, const Lanes<w>* a, const Lanes<w>* b, Split split) {
+        const word* m = PaddedWordArray<Modulus, n + 1>::value;
+        Lanes<w> t[n + 2], carry, q;
+        STATIC_BIGNUM_UNROLL
+        for (size_t j = 0; j < n + 2; ++j)
+            lanes_fill(t[j], 0);
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < n; ++i) {
+            lanes_fill(carry, 0);
+            STATIC_BIGNUM_UNROLL
+            for (size_t j = 0; j < n; ++j)
+                lanes_mul_add(t[j], a[j], Operand::template get<n>(b, i), t[j], carry, split);
+            STATIC_BIGNUM_LANES
+            for (size_t l = 0; l < w; ++l) {
+                t[n].v[l] += carry.v[l];
+                t[n + 1].v[l] = t[n].v[l] < carry.v[l] ? 1 : 0;
+                q.v[l] = t[0].v[l] * Montgomery<N>::inverse;
+                carry.v[l] = 0;
+            }
+            // the low word is zero, t[0] is overwritten next
+            lanes_mul_add(t[0], q, m[0], t[0], carry, split);
+            STATIC_BIGNUM_UNROLL
+            for (size_t j = 1; j < n; ++j)
+                lanes_mul_add(t[j - 1], q, m[j], t[j], carry, split);
+            STATIC_BIGNUM_LANES
+            for (size_t l = 0; l < w; ++l) {
+                t[n - 1].v[l] = t[n].v[l] + carry.v[l];
+                t[n].v[l] = t[n + 1].v[l] + (t[n - 1].v[l] < carry.v[l] ? 1 : 0);
+            }
+        }
+        // t < 2 * N
+        lanes_subtract_if_not_less<n + 1>(t, m);
+        STATIC_BIGNUM_UNROLL
+        for (size_t j = 0; j < n; ++j)
+            r[j] = t[j];
+    }
+    static STATIC_BIGNUM_ALWAYS_INLINE Out output(word z) { return z; }
+};
+
+// r = a ** e / R ** (e - 1) mod N as Montgomery<N>::pow computes it, for
+// one exponent of e_length words shared by all elements
+template<class N>
+struct BatchMontgomeryPow {
+    using Mul = BatchMontgomery<N, void>;
+    static const size_t n = Mul::length;
+    static const bool binary = false;
+    using Out = word;
+    static const size_t length = n, outputs = n;
+    static const bool multiplies = true;
+
+    const word* e;
+    size_t e_length;
+
+    template<size_t w, class Split>
+    STATIC_BIGNUM_ALWAYS_INLINE void block(Lanes<w>* r, const Lanes<w>* a, const Lanes<w>*, Split split) const {
+        Lanes<w> result[n];
+        STATIC_BIGNUM_UNROLL
+        for (size_t j = 0; j < n; ++j)
+            lanes_fill(result[j], Montgomery<N>::one()[j]);
+        // the exponent is the same in every lane, and so are the branches
+        for (size_t i = e_length; i-- > 0;)
+            for (int bit = word_bits - 1; bit >= 0; --bit) {
+                Mul::block(result, result, result, split);
+                if ((e[i] >> bit) & 1)
+                    Mul::block(result, result, a, split);
+            }
+        STATIC_BIGNUM_UNROLL
+        for (size_t j = 0; j < n; ++j)
+            r[j] = result[j];
+    }
+    static STATIC_BIGNUM_ALWAYS_INLINE Out output(word z) { return z; }
+};
+
+// elements per block for kernel K: products of 64 or 128-bit words only
+// vectorize when split into half words
+template<class K, class Split>
+struct BatchWidth : std::integral_constant<size_t,
+    (K::multiplies && !Split::value && word_bits > 32 ? 1 : batch_block)> {};
+
+// runs kernel K over count elements; b is only read by binary kernels
+template<class K, class Split>
+STATIC_BIGNUM_ALWAYS_INLINE void batch_run(const K& kernel, typename K::Out* r, const word* a, const word* b, size_t count) {
+    const size_t n = K::length, w = BatchWidth<K, Split>::value;
+    Lanes<w> x[n], y[K::binary ? n : 1], z[K::outputs];
+    for (size_t k0 = 0; k0 < count; k0 += w) {
+        const size_t m = count - k0 < w ? count - k0 : w;
+        if (m == w) {
+            STATIC_BIGNUM_UNROLL
+            for (size_t i = 0; i < n; ++i) {
+                std::memcpy(x[i].v, a + i * count + k0, sizeof(Lanes<w>));
+                if (K::binary)
+                    std::memcpy(y[i].v, b + i * count + k0, sizeof(Lanes<w>));
+            }
+        } else {
+            // the last block is padded with zeros
+            STATIC_BIGNUM_UNROLL
+            for (size_t i = 0; i < n; ++i) {
+                lanes_fill(x[i], 0);
+                std::memcpy(x[i].v, a + i * count + k0, m * sizeof(word));
+                if (K::binary) {
+                    lanes_fill(y[i], 0);
+                    std::memcpy(y[i].v, b + i * count + k0, m * sizeof(word));
+                }
+            }
+        }
+        kernel.block(z, x, y, Split());
+        STATIC_BIGNUM_UNROLL
+        for (size_t i = 0; i < K::outputs; ++i) {
+            if (m == w) {
+                STATIC_BIGNUM_LANES
+                for (size_t k = 0; k < w; ++k)
+                    r[i * count + k0 + k] = K::output(z[i].v[k]);
+            } else {
+                for (size_t k = 0; k < m; ++k)
+                    r[i * count + k0 + k] = K::output(z[i].v[k]);
+            }
+        }
+    }
+}
+
+#ifdef STATIC_BIGNUM_BATCH_DISPATCH
+// AVX2 has no 64 x 64 bit vector multiplication, and scalar products beat
+// four half word ones there, so only AVX-512 splits 64-bit words
+template<class K>
+__attribute__((target("avx512f")))
+void batch_run_avx512(const K& kernel, typename K::Out* r, const word* a, const word* b, size_t count) {
+    batch_run<K, std::integral_constant<bool, word_bits == 64>>(kernel, r, a, b, count);
+}
+
+template<class K>
+__attribute__((target("avx2")))
+void batch_run_avx2(const K& kernel, typename K::Out* r, const word* a, const word* b, size_t count) {
+    batch_run<K, std::false_type>(kernel, r, a, b, count);
+}
+#endif
+
+template<class K>
+inline void batch_dispatch(const K& kernel, typename K::Out* r, const word* a, const word* b, size_t count) {
+#ifdef STATIC_BIGNUM_BATCH_DISPATCH
+    switch (batch_target()) {
+    case BatchTarget::avx512:
+        return batch_run_avx512(kernel, r, a, b, count);
+    case BatchTarget::avx2:
+        return batch_run_avx2(kernel, r, a, b, count);
+    default:
+        break;
+    }
+#endif
+    batch_run<K, std::false_type>(kernel, r, a, b, count);
+}
+
+// Operations on batches of count numbers of limbs words. Results have the
+// same layout and may alias the inputs; static operands are BigUnsigned
+// values and their words are constants in the kernels.
+template<size_t limbs>
+struct Batch {
+    static_assert(limbs > 0, "Batch needs at least one word");
+    static const size_t length = limbs;
+
+    // r = a + b and r = a - b modulo P ** limbs
+    static inline void add(word* r, const word* a, const word* b, size_t count) {
+        batch_dispatch(BatchAdd<limbs, void>(), r, a, b, count);
+    }
+    template<word d, class T>
+    static inline void add(word* r, const word* a, BigUnsigned<d, T>, size_t count) {
+        batch_dispatch(BatchAdd<limbs, BigUnsigned<d, T>>(), r, a, nullptr, count);
+    }
+    static inline void subtract(word* r, const word* a, const word* b, size_t count) {
+        batch_dispatch(BatchSubtract<limbs, void>(), r, a, b, count);
+    }
+    template<word d, class T>
+    static inline void subtract(word* r, const word* a, BigUnsigned<d, T>, size_t count) {
+        batch_dispatch(BatchSubtract<limbs, BigUnsigned<d, T>>(), r, a, nullptr, count);
+    }
+
+    // r[k] = -1, 0 or 1 as element k of a is less than, equal to or greater than b
+    static inline void compare(int8_t* r, const word* a, const word* b, size_t count) {
+        batch_dispatch(BatchCompare<limbs, void>(), r, a, b, count);
+    }
+    template<word d, class T>
+    static inline void compare(int8_t* r, const word* a, BigUnsigned<d, T>, size_t count) {
+        batch_dispatch(BatchCompare<limbs, BigUnsigned<d, T>>(), r, a, nullptr, count);
+    }
+
+    // r = a mod M with M::length words per element of r
+    template<word d, class T>
+    static inline void reduce(word* r, const word* a, BigUnsigned<d, T>, size_t count) {
+        batch_dispatch(BatchReduce<limbs, BigUnsigned<d, T>>(), r, a, nullptr, count);
+    }
+
+    // Montgomery<N>::mul, to_montgomery and from_montgomery for an odd N of
+    // limbs words, with the same conditions on the arguments
+    template<word d, class T>
+    static inline void montgomery_mul(word* r, const word* a, const word* b, BigUnsigned<d, T>, size_t count) {
+        static_assert(Montgomery<BigUnsigned<d, T>>::length == limbs, "modulus length differs from limbs");
+        batch_dispatch(BatchMontgomery<BigUnsigned<d, T>, void>(), r, a, b, count);
+    }
+    template<word d, class T>
+    static inline void to_montgomery(word* r, const word* a, BigUnsigned<d, T>, size_t count) {
+        static_assert(Montgomery<BigUnsigned<d, T>>::length == limbs, "modulus length differs from limbs");
+        using R2 = typename Montgomery<BigUnsigned<d, T>>::R2;
+        batch_dispatch(BatchMontgomery<BigUnsigned<d, T>, R2>(), r, a, nullptr, count);
+    }
+    template<word d, class T>
+    static inline void from_montgomery(word* r, const word* a, BigUnsigned<d, T>, size_t count) {
+        static_assert(Montgomery<BigUnsigned<d, T>>::length == limbs, "modulus length differs from limbs");
+        batch_dispatch(BatchMontgomery<BigUnsigned<d, T>, One>(), r, a, nullptr, count);
+    }
+    // Montgomery<N>::pow for every element of a, with the same exponent
+    template<word d, class T>
+    static inline void montgomery_pow(word* r, const word* a, const word* e, size_t e_length, BigUnsigned<d, T>, size_t count) {
+        static_assert(Montgomery<BigUnsigned<d, T>>::length == limbs, "modulus length differs from limbs");
+        const BatchMontgomeryPow<BigUnsigned<d, T>> kernel = {e, e_length};
+        batch_dispatch(kernel, r, a, nullptr, count);
+    }
 };
 
 };
@@ -0,0 +1,233 @@
+#ifndef STATIC_BIGNUM_PARALLEL_HPP
+#define STATIC_BIGNUM_PARALLEL_HPP
+
+// Batch kernels of static_bignum.hpp over several threads. Kept apart from
+// the main header so that it stays free of <thread>; link with the
+// platform's thread library (Threads::Threads in CMake).
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "static_bignum.hpp"
+
+namespace static_bignum {
+
+///////////////////////////////////////////////////////////////////////////
+///////////////////////////// parallel batches ////////////////////////////
+///////////////////////////////////////////////////////////////////////////
+
+// what one worker did during a parallel run
+struct WorkerStats {
+    size_t elements;  // elements processed
+    size_t chunks;    // chunks processed, stolen ones included
+    size_t stolen;    // chunks taken from other workers
+    double seconds;   // from the start of the run until the worker ran out of work
+
+    // elements per second
+    inline double throughput(void) const {
+        return seconds > 0 ? elements / seconds : 0;
+    }
+};
+
+struct ParallelStats {
+    std::vector<WorkerStats> workers;
+    size_t elements;
+    double seconds;   // wall time of the run
+
+    inline double throughput(void) const {
+        return seconds > 0 ? elements / seconds : 0;
+    }
+};
+
+// scratch memory of one worker, kept across chunks and runs, so that it is
+// only allocated while it grows
+struct ScratchArena {
+    std::vector<word> storage;
+
+    // at least size words, valid until the next call
+    inline word* words(size_t size) {
+        if (storage.size() < size)
+            storage.resize(size);
+        return storage.data();
+    }
+};
+
+// chunks [front, back) left to one worker, packed into one word so that
+// the owner and thieves claim them with a single compare and swap; padded
+// to a cache line of its own
+struct ChunkQueue {
+    std::atomic<uint64_t> range;
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+
+    // the owner takes chunks from the front
+    inline bool pop_front(size_t& chunk) {
+        uint64_t r = range.load(std::memory_order_relaxed);
+        while ((r & 0xFFFFFFFF) < (r >> 32)) {
+            if (range.compare_exchange_weak(r, r + 1, std::memory_order_relaxed)) {
+                chunk = static_cast<size_t>(r & 0xFFFFFFFF);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // thieves take them from the back, away from the owner
+    inline bool pop_back(size_t& chunk) {
+        uint64_t r = range.load(std::memory_order_relaxed);
+        while ((r & 0xFFFFFFFF) < (r >> 32)) {
+            if (range.compare_exchange_weak(r, r - (uint64_t(1) << 32), std::memory_order_relaxed)) {
+                chunk = static_cast<size_t>((r >> 32) - 1);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Runs batch operations over several threads. The count elements of a run
+// are cut into chunks of whole batch blocks and dealt out to the workers
+// in contiguous runs of chunks; a worker that runs out takes the last
+// chunks of the others. Operands and results are batches of count numbers
+// as Batch lays them out, and each chunk is copied to the scratch arena of
+// its worker, where the batch kernels work on it in cache. Threads are
+// started for every run, the calling thread being worker 0, so runs should
+// be long enough to hide that; one run at a time per executor.
+struct BatchExecutor {
+    // threads = 0 takes one per hardware thread
+    explicit BatchExecutor(size_t threads = 0, size_t chunk = 4096)
+        : thread_count(threads ? threads : std::thread::hardware_concurrency()),
+          chunk_size((chunk + batch_block - 1) / batch_block * batch_block) {
+        if (thread_count == 0)
+            thread_count = 1;
+        if (chunk_size == 0)
+            chunk_size = batch_block;
+        arenas.resize(thread_count);
+    }
+
+    inline size_t threads(void) const { return thread_count; }
+    inline size_t chunk(void) const { return chunk_size; }
+
+    // calls f(begin, end, scratch) on disjoint ranges [begin, end) that
+    // cover [0, count), on as many threads as there are chunks, up to
+    // threads(); the first exception thrown by f is rethrown once all
+    // workers are done
+    template<class F>
+    ParallelStats run(size_t count, F f) {
+        using Clock = std::chrono::steady_clock;
+        size_t chunk = chunk_size;
+        while ((count + chunk - 1) / chunk > 0xFFFFFFFF)
+            chunk *= 2;
+        const size_t chunks = (count + chunk - 1) / chunk;
+        const size_t workers = chunks < thread_count ? (chunks ? chunks : 1) : thread_count;
+
+        std::unique_ptr<ChunkQueue[]> queues(new ChunkQueue[workers]);
+        for (size_t w = 0; w < workers; ++w) {
+            const uint64_t front = chunks * w / workers, back = chunks * (w + 1) / workers;
+            queues[w].range.store(front | back << 32, std::memory_order_relaxed);
+        }
+        ParallelStats stats;
+        stats.workers.assign(workers, WorkerStats());
+        stats.elements = count;
+        std::vector<std::exception_ptr> errors(workers);
+
+        const Clock::time_point start = Clock::now();
+        auto work = [&](size_t w) {
+            WorkerStats s = WorkerStats();
+            ScratchArena& scratch = arenas[w];
+            auto process = [&](size_t c) {
+                const size_t begin = c * chunk, end = count - begin < chunk ? count : begin + chunk;
+                f(begin, end, scratch);
+                s.elements += end - begin;
+                ++s.chunks;
+            };
+            try {
+                size_t c;
+                while (queues[w].pop_front(c))
+                    process(c);
+                // nobody adds chunks, so one pass over the others is enough
+                for (size_t v = 1; v < workers; ++v)
+                    while (queues[(w + v) % workers].pop_back(c)) {
+                        process(c);
+                        ++s.stolen;
+                    }
+            } catch (...) {
+                errors[w] = std::current_exception();
+            }
+            s.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            stats.workers[w] = s;
+        };
+        std::vector<std::thread> pool;
+        try {
+            pool.reserve(workers - 1);
+            for (size_t w = 1; w < workers; ++w)
+                pool.emplace_back(work, w);
+        } catch (const std::system_error&) {
+            // fewer threads; the chunks of the missing workers get stolen
+        }
+        work(0);
+        for (size_t i = 0; i < pool.size(); ++i)
+            pool[i].join();
+        stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        for (size_t w = 0; w < workers; ++w)
+            if (errors[w])
+                std::rethrow_exception(errors[w]);
+        return stats;
+    }
+
+    // r = a mod M for a of limbs words, with M::length words per element of r
+    template<size_t limbs, word d, class T>
+    ParallelStats reduce(word* r, const word* a, BigUnsigned<d, T> m, size_t count) {
+        const size_t k = Optimize<BigUnsigned<d, T>>::Result::length;
+        return run(count, [=](size_t begin, size_t end, ScratchArena& scratch) {
+            const size_t size = end - begin;
+            word* x = scratch.words((limbs + k) * size);
+            word* y = x + limbs * size;
+            gather(x, a, limbs, count, begin, size);
+            Batch<limbs>::reduce(y, x, m, size);
+            scatter(r, y, k, count, begin, size);
+        });
+    }
+
+    // r = a ** e mod N for a of limbs words and an odd N, with N::length
+    // words per element of r; e is given by e_length words, least
+    // significant first, and is the same for every element
+    template<size_t limbs, word d, class T>
+    ParallelStats pow_mod(word* r, const word* a, const word* e, size_t e_length, BigUnsigned<d, T> m, size_t count) {
+        const size_t n = Montgomery<BigUnsigned<d, T>>::length;
+        return run(count, [=](size_t begin, size_t end, ScratchArena& scratch) {
+            const size_t size = end - begin;
+            word* x = scratch.words((limbs + n) * size);
+            word* y = x + limbs * size;
+            gather(x, a, limbs, count, begin, size);
+            Batch<limbs>::reduce(y, x, m, size);
+            Batch<n>::to_montgomery(y, y, m, size);
+            Batch<n>::montgomery_pow(y, y, e, e_length, m, size);
+            Batch<n>::from_montgomery(y, y, m, size);
+            scatter(r, y, n, count, begin, size);
+        });
+    }
+
+private:
+    // elements [begin, begin + size) of a batch of count numbers of length
+    // words to a batch of their own and back
+    static inline void gather(word* r, const word* a, size_t length, size_t count, size_t begin, size_t size) {
+        for (size_t i = 0; i < length; ++i)
+            std::memcpy(r + i * size, a + i * count + begin, size * sizeof(word));
+    }
+    static inline void scatter(word* r, const word* a, size_t length, size_t count, size_t begin, size_t size) {
+        for (size_t i = 0; i < length; ++i)
+            std::memcpy(r + i * count + begin, a + i * size, size * sizeof(word));
+    }
+
+    size_t thread_count, chunk_size;
+    std::vector<ScratchArena> arenas;
+};
+
+};
+
+#endif